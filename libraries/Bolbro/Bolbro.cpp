@@ -35,6 +35,7 @@ BolbroClass::BolbroClass() {
 	mStartSeconds = 0;
 	mSerialBaud = 115200;
 	mOpenHABHost = NULL;
+	mOpenHABErrors = 0;
 	mNetworks[0].ssid = NULL;
 	mUnresolvedWAN[0] = NULL;
 	mWANs[0] = IPAddress();
@@ -435,8 +436,10 @@ bool BolbroClass::sendItemCommand(const char *item, const String& status) {
 		if (httpResponseCode>0) {
 			LOG->printf("sent command %s to item %s (%d)\n", status.c_str(), item, httpResponseCode);
 			result = true;
-		} else
+		} else {
 			LOG->printf("error on sending %s POST: %d\n", item, httpResponseCode);
+			mOpenHABErrors++;
+		}
 
 		http.end();
 	}
@@ -477,8 +480,48 @@ bool BolbroClass::updateItem(const char *item, const String& status) {
 		if (httpResponseCode==202) {
 			LOG->printf("updated %s to %s (%d)\n", item, status.c_str(), httpResponseCode);
 			result = true;
-		} else
+		} else {
 			LOG->printf("error on sending %s PUT: %d\n", item, httpResponseCode);
+			mOpenHABErrors++;
+		}
+
+		http.end();
+	}
+
+	return result;
+}
+
+unsigned long BolbroClass::openHABErrors() {
+	return mOpenHABErrors;
+}
+
+bool BolbroClass::callURL(const char *url) {
+
+	bool result = false;
+
+	//  Connect to WiFi in case we are not connected already...
+	if (connectToWiFi())
+	{
+#if !NEWHTTPCLIENT
+		WiFiClient client;
+#endif
+		HTTPClient http;
+
+#if NEWHTTPCLIENT
+		http.begin(url);
+#else
+		http.begin(client, url);
+#endif
+
+		http.setTimeout(1000);
+
+		int httpResponseCode = http.GET();
+
+		if (httpResponseCode>=200&&httpResponseCode<300) {
+			LOG->printf("called %s (%d)\n", url, httpResponseCode);
+			result = true;
+		} else
+			LOG->printf("error on calling %s: %d\n", url, httpResponseCode);
 
 		http.end();
 	}
@@ -71,6 +71,12 @@ class BolbroClass
 		bool sendItemCommand(const char *item, const String& status);
 		bool updateItem(const char *item, const String& status);
 
+		//	commands and updates not accepted by openHAB since start
+		unsigned long openHABErrors();
+
+		//	generic HTTP GET, e.g. to call webhooks; true on a 2xx response
+		bool callURL(const char *url);
+
 		//	Utility updating the signalStrength item (Number) whenever the WiFi RSSI changes
 		void setSignalStrengthItem(const char *item);
 
@@ -117,6 +123,7 @@ class BolbroClass
 		} mNetworks [MAX_NETWORKS+1];
 
 		const char *mOpenHABHost;
+		unsigned long mOpenHABErrors;
 		long mSerialBaud;
 
 #define MAX_UNRESOLVED_WANS 10
@@ -1,24 +1,89 @@
 #include <BolbroWebServer.h>
 #include <Bolbro.h>
+#include <JsonWriter.h>
 
 #if HASSPIFFS
 #	include <SPIFFS.h> // for access to image data
 #endif
 
+#ifdef ESP_PLATFORM
+#	include <lwip/sockets.h> // select() on client sockets
+#endif
+
+/* --------------------------------------------------------------------------------
+	Sources of generated bodies
+   -------------------------------------------------------------------------------- */
+
+size_t BolbroPrintSource::read(uint8_t *buffer, size_t size) {
+  unsigned long start = millis();
+  size_t length = 0;
+
+  while (length<size) {
+    if (mPosition<mOut.length()) {
+      size_t part = mOut.length()-mPosition;
+
+      if (part>size-length)
+        part = size-length;
+      memcpy(buffer+length, mPiece+mPosition, part);
+      mPosition += part;
+      length += part;
+    } else if (mDone||(length>0&&millis()-start>=BOLBRO_PIECEMILLIS))
+      break;
+    else {
+      mOut.reset();
+      mPosition = 0;
+      mDone = !printPiece(&mOut);
+      if (mOut.overflow())
+        LOG->printf("piece exceeds %d bytes, truncated\n", BOLBRO_PIECESIZE);
+    }
+  }
+
+  return length;
+}
+
 /* --------------------------------------------------------------------------------
 	WebServer base class to be customized
    -------------------------------------------------------------------------------- */
 
-BolbroWebServer::BolbroWebServer() : WebServer(80) {
+BolbroWebServer::BolbroWebServer() : WebServer(80), mChunkedResponse(this) {
+  mTextMessage[0] = '\0';
+  mTextMessageLoaded = false;
+  mLastEventMillis = 0;
+  mEventLength = 0;
+  for (int i = 0; i<BOLBRO_MAXSUBSCRIBERS; i++)
+    mSubscribers[i].sent = 0;
+
+  for (int i = 0; i<BOLBRO_ROUTESLOTS; i++)
+    mRoutes[i].path = NULL;
+  mNumRoutes = 0;
+  mAssets = NULL;
+
+  memset(mRateClients, 0, sizeof(mRateClients));
+  memset(mAdmitted, 0, sizeof(mAdmitted));
+  memset(mRejected, 0, sizeof(mRejected));
+
+#if HASSPIFFS
+  for (int i = 0; i<BOLBRO_MAXTRANSFERS; i++)
+    mTransfers[i].active = false;
+#endif
 }
 
 void BolbroWebServer::begin() {
 
-  on("/restart", [this]() { CHECKLOCALACCESS handleRestart(); });
-  on("/reconnect", [this]() { CHECKLOCALACCESS handleReconnect(); });
-  on("/time", [this]() { CHECKLOCALACCESS handleTime(); });
-  on("/setmessage", [this]() { CHECKLOCALACCESS handleTextMessage(); });
-  onNotFound([this]() { CHECKLOCALACCESS handleNotFound(); });
+  route("/restart", [this]() { CHECKLOCALACCESS handleRestart(); }, AdminRoute);
+  route("/reconnect", [this]() { CHECKLOCALACCESS handleReconnect(); }, AdminRoute);
+  route("/time", [this]() { CHECKLOCALACCESS handleTime(); }, AdminRoute);
+  route("/setmessage", [this]() { CHECKLOCALACCESS handleTextMessage(); }, AdminRoute);
+  route("/ratelimits.json", [this]() { CHECKLOCALACCESS handleRateLimits(); }, AdminRoute);
+  route("/metrics", [this]() { CHECKLOCALACCESS handleMetrics(); }, AdminRoute);
+  onNotFound([this]() { if (admit(StaticRoute)) { CHECKLOCALACCESS handleNotFound(); } }); // scans are limited, too
+
+  addHandler(new RouteHandler(this)); // owned by WebServer
+
+  //  request headers evaluated, see notModified() and sendAsset(), Accept by subclasses
+  static const char *headerKeys[] = { "If-None-Match", "Accept-Encoding", "Accept" };
+
+  collectHeaders(headerKeys, sizeof(headerKeys)/sizeof(headerKeys[0]));
 
   WebServer::begin();
 
@@ -29,9 +94,296 @@ void BolbroWebServer::begin() {
 #endif
 }
 
+uint32_t BolbroWebServer::hashPath(const char *path, uint32_t seed) {
+  uint32_t hash = 2166136261u^seed;
+
+  while (*path) {
+    hash ^= (uint8_t) *path++;
+    hash *= 16777619u;
+  }
+
+  //  low bits select the slot, they would not depend on higher bits of seed and path
+  return hash^(hash>>16);
+}
+
+//  open addressing with linear probing; a path routed again gets the new handler
+bool BolbroWebServer::route(const char *path, THandlerFunction handler, RouteClass routeClass) {
+  uint32_t hash = hashPath(path);
+  Route *entry = findRoute(path, hash);
+
+  if (!entry) {
+    if (mNumRoutes>=BOLBRO_MAXROUTES) {
+      LOG->printf("route %s not added, increase BOLBRO_ROUTESLOTS\n", path);
+      return false;
+    }
+
+    entry = &mRoutes[hash&(BOLBRO_ROUTESLOTS-1)];
+    while (entry->path)
+      entry = &mRoutes[(entry-mRoutes+1)&(BOLBRO_ROUTESLOTS-1)];
+
+    entry->path = path;
+    entry->hash = hash;
+    entry->latency = mNumRoutes++;
+  }
+
+  entry->handler = handler;
+  entry->routeClass = routeClass;
+
+  return true;
+}
+
+//  milli tokens per minute equal requests per second, no floating point required
+static const struct {
+  uint32_t perMinute;
+  uint32_t burst;
+} rateLimits[BolbroWebServer::NumRouteClasses] = {
+  { BOLBRO_STATICRATE, BOLBRO_STATICBURST },
+  { BOLBRO_DYNAMICRATE, BOLBRO_DYNAMICBURST },
+  { BOLBRO_ADMINRATE, BOLBRO_ADMINBURST }
+};
+
+static const char *routeClassNames[BolbroWebServer::NumRouteClasses] = { "static", "dynamic", "admin" };
+
+//  take a token from the client's bucket, reply 429 and return false if there is none
+bool BolbroWebServer::admit(RouteClass routeClass) {
+  uint32_t address = client().remoteIP();
+  unsigned long now = millis();
+  RateClient *rateClient = &mRateClients[0];
+
+  //  the client's entry, or the least recently seen one to be replaced
+  for (int i = 0; i<BOLBRO_RATECLIENTS; i++) {
+    if (mRateClients[i].address==address) {
+      rateClient = &mRateClients[i];
+      break;
+    }
+    if (now-mRateClients[i].lastSeen>now-rateClient->lastSeen||!mRateClients[i].address)
+      rateClient = &mRateClients[i];
+  }
+
+  if (rateClient->address!=address) {
+    rateClient->address = address;
+    for (int c = 0; c<NumRouteClasses; c++)
+      rateClient->milliTokens[c] = rateLimits[c].burst*1000;
+  } else
+    for (int c = 0; c<NumRouteClasses; c++) {
+      //  at most the time to refill an empty bucket, longer idle times overflow
+      uint32_t refillMillis = rateLimits[c].burst*60000/rateLimits[c].perMinute;
+      uint32_t elapsed = now-rateClient->lastSeen<refillMillis?now-rateClient->lastSeen:refillMillis;
+      uint32_t milliTokens = rateClient->milliTokens[c]+elapsed*rateLimits[c].perMinute/60;
+
+      rateClient->milliTokens[c] = milliTokens<rateLimits[c].burst*1000?milliTokens:rateLimits[c].burst*1000;
+    }
+  rateClient->lastSeen = now;
+
+  uint32_t &milliTokens = rateClient->milliTokens[routeClass];
+
+  if (milliTokens>=1000) {
+    milliTokens -= 1000;
+    mAdmitted[routeClass]++;
+    return true;
+  }
+
+  //  seconds until the next token, rounded up
+  unsigned long retryAfter = ((1000-milliTokens)*60/rateLimits[routeClass].perMinute+999)/1000;
+
+  mRejected[routeClass]++;
+  sendHeader("Retry-After", String(retryAfter>0?retryAfter:1));
+  send(429, "text/plain", "too many requests");
+  LOG->printf("%s request from %s rejected\n", routeClassNames[routeClass], client().remoteIP().toString().c_str());
+
+  return false;
+}
+
+void BolbroWebServer::writeMetrics(Print *out) {
+  writeMetric(out, "bolbro_uptime_seconds", "gauge", "Time since start.", millis()/1000.0);
+#ifdef ESP_PLATFORM
+  writeMetric(out, "bolbro_heap_free_bytes", "gauge", "Free heap.", ESP.getFreeHeap());
+  writeMetric(out, "bolbro_heap_min_free_bytes", "gauge", "Lowest free heap since start.", ESP.getMinFreeHeap());
+  writeMetric(out, "bolbro_heap_max_alloc_bytes", "gauge", "Largest block available.", ESP.getMaxAllocHeap());
+#else
+  writeMetric(out, "bolbro_heap_free_bytes", "gauge", "Free heap.", ESP.getFreeHeap());
+  writeMetric(out, "bolbro_heap_max_alloc_bytes", "gauge", "Largest block available.", ESP.getMaxFreeBlockSize());
+#endif
+  writeMetric(out, "bolbro_openhab_errors_total", "counter", "Item updates and commands not accepted by openHAB.", Bolbro.openHABErrors());
+  writeMetric(out, "bolbro_event_subscribers", "gauge", "Open Server-Sent Events streams.", numSubscribers());
+
+  out->print("# HELP bolbro_http_requests_rejected_total Requests answered with 429.\n"
+    "# TYPE bolbro_http_requests_rejected_total counter\n");
+  for (int c = 0; c<NumRouteClasses; c++)
+    out->printf("bolbro_http_requests_rejected_total{class=\"%s\"} %lu\n", routeClassNames[c], mRejected[c]);
+
+  //  routes not requested yet are left out
+  LatencyHistogram::writeHeader(out, "bolbro_http_request_duration_seconds", "Time spent in request handlers.");
+  for (int i = 0; i<BOLBRO_ROUTESLOTS; i++) {
+    Route &entry = mRoutes[i];
+
+    if (entry.path&&mRouteLatency[entry.latency].count()) {
+      char labels[128];
+
+      snprintf(labels, sizeof(labels), "path=\"%s\",class=\"%s\"", entry.path, routeClassNames[entry.routeClass]);
+      mRouteLatency[entry.latency].write(out, "bolbro_http_request_duration_seconds", labels);
+    }
+  }
+  if (mAssetLatency.count())
+    mAssetLatency.write(out, "bolbro_http_request_duration_seconds", "path=\"assets\",class=\"static\"");
+}
+
+void BolbroWebServer::handleMetrics() {
+  beginChunkedResponse(200, METRICS_CONTENTTYPE);
+  writeMetrics(chunkedResponse());
+  endChunkedResponse();
+}
+
+unsigned long BolbroWebServer::admitted(RouteClass routeClass) {
+  return mAdmitted[routeClass];
+}
+
+unsigned long BolbroWebServer::rejected(RouteClass routeClass) {
+  return mRejected[routeClass];
+}
+
+void BolbroWebServer::handleRateLimits() {
+  beginChunkedResponse(200, "application/json");
+
+  JsonWriter json(chunkedResponse());
+
+  json.beginObject();
+  for (int c = 0; c<NumRouteClasses; c++) {
+    json.beginObject(routeClassNames[c]);
+    json.number("admitted", (long) mAdmitted[c]);
+    json.number("rejected", (long) mRejected[c]);
+    json.endObject();
+  }
+  json.endObject();
+
+  endChunkedResponse();
+}
+
+BolbroWebServer::Route *BolbroWebServer::findRoute(const char *path, uint32_t hash) {
+  for (uint32_t i = 0; i<BOLBRO_ROUTESLOTS; i++) {
+    Route *route = &mRoutes[(hash+i)&(BOLBRO_ROUTESLOTS-1)];
+
+    if (!route->path)
+      return NULL;
+    if (route->hash==hash&&strcmp(route->path, path)==0)
+      return route;
+  }
+
+  return NULL;
+}
+
+//  true if the client's socket accepts data without blocking
+static bool writable(WiFiClient &client) {
+#ifdef ESP_PLATFORM
+  int fd = client.fd();
+  fd_set writeSet;
+  struct timeval timeout = { 0, 0 };
+
+  if (fd<0)
+    return false;
+
+  FD_ZERO(&writeSet);
+  FD_SET(fd, &writeSet);
+
+  return select(fd+1, NULL, &writeSet, NULL, &timeout)>0;
+#else
+  return client.availableForWrite()>0;
+#endif
+}
+
+void BolbroWebServer::handleClient() {
+  WebServer::handleClient();
+
+  keepEventStreamsAlive();
+  continueEvents();
+
+#if HASSPIFFS
+  continueTransfers();
+#endif
+}
+
 #if HASSPIFFS
 
-//  read a file from SPIFFS and optionally replace substrings
+//  replaces substrings in a single pass while printing to out, the longest one if
+//  several start at the same position; only output which may still become part of a
+//  substring is held back, so memory does not depend on the amount of text; empty
+//  substrings and those longer than BOLBRO_MAXSUBSTRING are never replaced
+class Substitution : public Print
+{
+  public:
+
+    Substitution(Print *out, int numReplacements, const char **subStrings, const char **replacements) {
+      mOut = out;
+      mNumReplacements = numReplacements;
+      mSubStrings = subStrings;
+      mReplacements = replacements;
+      mLength = 0;
+    }
+
+    using Print::write;
+
+    size_t write(uint8_t c) {
+      mPending[mLength++] = c;
+
+      while (mLength>0&&!isPrefix())
+        advance();
+
+      return 1;
+    }
+
+    void flush() {
+      while (mLength>0)
+        advance();
+    }
+
+  private:
+
+    Print *mOut;
+    int mNumReplacements;
+    const char **mSubStrings;
+    const char **mReplacements;
+    char mPending[BOLBRO_MAXSUBSTRING];
+    size_t mLength;
+
+    //  true if mPending may still grow into a substring
+    bool isPrefix() {
+      for (int i = 0; i<mNumReplacements; i++) {
+        size_t length = strlen(mSubStrings[i]);
+
+        if (length>mLength&&length<=BOLBRO_MAXSUBSTRING&&memcmp(mSubStrings[i], mPending, mLength)==0)
+          return true;
+      }
+
+      return false;
+    }
+
+    //  replace the longest substring mPending starts with, or pass its first character on
+    void advance() {
+      size_t matchLength = 0;
+      int match = -1;
+
+      for (int i = 0; i<mNumReplacements; i++) {
+        size_t length = strlen(mSubStrings[i]);
+
+        if (length>matchLength&&length<=mLength&&memcmp(mSubStrings[i], mPending, length)==0) {
+          match = i;
+          matchLength = length;
+        }
+      }
+
+      if (match>=0)
+        mOut->print(mReplacements[match]);
+      else {
+        mOut->write((uint8_t) mPending[0]);
+        matchLength = 1;
+      }
+
+      mLength -= matchLength;
+      memmove(mPending, mPending+matchLength, mLength);
+    }
+};
+
+//  read a file from SPIFFS and optionally replace substrings, streamed in chunks
 void BolbroWebServer::returnFile(const char *path, const char *mimeType,
   int numReplacements, const char **subStrings, const char **replacements)
 {
@@ -43,25 +395,25 @@ void BolbroWebServer::returnFile(const char *path, const char *mimeType,
   }
   else
   {
-    String out = "";
+    Substitution out(chunkedResponse(), numReplacements, subStrings, replacements);
+    uint8_t buffer[256];
+    size_t size;
 
-    while(file.available())
-      out += file.readString();
+    beginChunkedResponse(200, mimeType);
+    while ((size = file.read(buffer, sizeof(buffer)))>0)
+      out.write(buffer, size);
+    out.flush();
     file.close();
-
-    for (int i = 0; i<numReplacements; i++)
-      out.replace(subStrings[i], replacements[i]);
-
-    send(200, mimeType, out);
+    endChunkedResponse();
 
     LOG->printf("file %s read, patched, and sent\n", path);
   }
 }
 
-bool BolbroWebServer::loadFromSpiffs(String path)
+BolbroWebServer::TransferResult BolbroWebServer::loadFromSpiffs(String path, const char *eTag, const char *cacheControl)
 {
   String dataType = "text/plain";
-  bool result = true;
+  TransferResult result = TransferStarted;
 
   if (path.endsWith(".src"))
     path = path.substring(0, path.lastIndexOf("."));
@@ -94,27 +446,477 @@ bool BolbroWebServer::loadFromSpiffs(String path)
     if (hasArg("download"))
       dataType = "application/octet-stream";
 
-    sendHeader("Cache-Control", "max-age=1000");
-    setContentLength(dataFile.size());
+    if (beginTransfer(dataFile)) {
+      sendHeader("Cache-Control", cacheControl);
+      if (eTag)
+        sendHeader("ETag", eTag);
+      setContentLength(dataFile.size());
+      send(200, dataType.c_str(), ""); // header only, the body follows from handleClient()
+      releaseClient();
+      LOG->printf("file %s transfer started\n", path.c_str());
+    } else {
+      sendBusy(path.c_str());
+      dataFile.close();
+      result = TransferBusy;
+    }
+  } else {
+      LOG->printf("file %s does not exist...\n", path.c_str());
+      result = TransferNotFound;
+  }
+
+  return result;
+}
+
+//  a free slot for the current client, NULL if all BOLBRO_MAXTRANSFERS are in use
+BolbroWebServer::Transfer *BolbroWebServer::reserveTransfer(const char *name) {
+  for (int i = 0; i<BOLBRO_MAXTRANSFERS; i++) {
+    Transfer &transfer = mTransfers[i];
+
+    if (!transfer.active) {
+      transfer.client = client();
+      transfer.name = name;
+      transfer.file = File();
+      transfer.data = NULL;
+      transfer.source = NULL;
+      transfer.chunked = false;
+      transfer.remaining = 0;
+      transfer.sent = 0;
+      transfer.lastProgress = millis();
+      transfer.active = true;
+
+      return &transfer;
+    }
+  }
+
+  return NULL;
+}
+
+//  false if all BOLBRO_MAXTRANSFERS slots are in use
+bool BolbroWebServer::beginTransfer(File &file) {
+  Transfer *transfer = reserveTransfer(file.name());
 
-    result = streamFile(dataFile, dataType) == dataFile.size();
+  if (!transfer)
+    return false;
 
-    if (result)
-      LOG->printf("file %s read and sent\n", path.c_str());
-    else
-      LOG->printf("sending file %s failed...\n", path.c_str());
+  transfer->file = file;
+  transfer->remaining = file.size();
+
+  return true;
+}
+
+//  data has to stay valid until sent, e.g. const data in flash
+bool BolbroWebServer::beginTransfer(const uint8_t *data, size_t size, const char *name) {
+  Transfer *transfer = reserveTransfer(name);
+
+  if (!transfer)
+    return false;
+
+  transfer->data = data;
+  transfer->remaining = size;
+
+  return true;
+}
 
-    dataFile.close();
+//  name has to stay valid until sent, e.g. a literal; headers are added once a slot is
+//  reserved, so a 503 goes without them
+bool BolbroWebServer::beginTransfer(BolbroTransferSource *source, const char *mimeType, const char *name,
+  const char *fileName) {
+  Transfer *transfer = reserveTransfer(name);
+
+  if (!transfer) {
+    delete source;
+    sendBusy(name);
+    return false;
+  }
+
+  if (fileName)
+    sendHeader("Content-Disposition", String("attachment; filename=\"")+fileName+"\"");
+  beginChunkedResponse(200, mimeType); // header only, the body follows from handleClient()
+
+  //  WebServer decided on chunked encoding by the client's HTTP version, the transfer
+  //  frames the chunks from now on
+  transfer->source = source;
+  transfer->chunked = _chunked;
+  transfer->remaining = 1;
+  _chunked = false;
+  releaseClient();
+
+  LOG->printf("file %s transfer started\n", name);
+
+  return true;
+}
+
+void BolbroWebServer::serveAssets(const BolbroAssetTable *table) {
+  mAssets = table;
+}
+
+//  one probe, the perfect hash maps every path in the table to a slot of its own
+const BolbroAsset *BolbroWebServer::findAsset(const char *path) {
+  if (!mAssets)
+    return NULL;
+
+  int index = mAssets->slots[hashPath(path, mAssets->seed)&(mAssets->numSlots-1)];
+
+  if (index<0||strcmp(mAssets->assets[index].path, path)!=0)
+    return NULL;
+
+  return &mAssets->assets[index];
+}
+
+//  caching and encoding headers are sent with the file only, so a 503 is not cached in its place
+void BolbroWebServer::sendAsset(const BolbroAsset &asset) {
+  if (asset.gzipped) {
+    sendHeader("Vary", "Accept-Encoding");
+
+    //  all browsers accept gzip, other clients may get the file from SPIFFS
+    if (header("Accept-Encoding").indexOf("gzip")<0) {
+      char eTag[48];
+
+      snprintf(eTag, sizeof(eTag), "%.*s-identity\"", (int) strlen(asset.eTag)-1, asset.eTag);
+      if (header("If-None-Match")==eTag)
+        notModified(eTag, asset.cacheControl);
+      else if (loadFromSpiffs(asset.path, eTag, asset.cacheControl)==TransferNotFound)
+        send(406, "text/plain", "gzip encoding required");
+      return;
+    }
+  }
+
+  if (header("If-None-Match")==asset.eTag) {
+    notModified(asset.eTag, asset.cacheControl);
+    return;
+  }
+
+  if (beginTransfer(asset.data, asset.size, asset.path)) {
+    sendHeader("Cache-Control", asset.cacheControl);
+    sendHeader("ETag", asset.eTag);
+    if (asset.gzipped)
+      sendHeader("Content-Encoding", "gzip");
+    setContentLength(asset.size);
+    send(200, asset.mimeType, ""); // header only, the body follows from handleClient()
+    releaseClient();
+    LOG->printf("file %s transfer started from flash\n", asset.path);
+  } else
+    sendBusy(asset.path);
+}
+
+void BolbroWebServer::sendBusy(const char *name) {
+  sendHeader("Cache-Control", "no-store");
+  sendHeader("Retry-After", "1");
+  send(503, "text/plain", "busy");
+  LOG->printf("sending file %s deferred, %d transfers active\n", name, BOLBRO_MAXTRANSFERS);
+}
+
+void BolbroWebServer::continueTransfers() {
+  for (int i = 0; i<BOLBRO_MAXTRANSFERS; i++) {
+    Transfer &transfer = mTransfers[i];
+
+    if (transfer.active&&!continueTransfer(transfer)) {
+      delete transfer.source;
+      transfer.source = NULL;
+      transfer.file.close();
+      transfer.client.stop();
+      transfer.client = WiFiClient();
+      transfer.active = false;
+    }
+  }
+}
+
+//  send the next portion if the socket has room, false once finished or failed
+bool BolbroWebServer::continueTransfer(Transfer &transfer) {
+  if (transfer.remaining==0)
+    return false;
+
+  if (!transfer.client.connected()) {
+    LOG->printf("file %s: client disconnected after %u bytes\n", transfer.name, (unsigned) transfer.sent);
+    return false;
+  }
+
+  if (!writable(transfer.client)) {
+    if (millis()-transfer.lastProgress<BOLBRO_TRANSFERTIMEOUT)
+      return true;
+
+    LOG->printf("file %s: client stalled after %u bytes\n", transfer.name, (unsigned) transfer.sent);
+    return false;
+  }
+
+  size_t size;
+  const uint8_t *buffer = transfer.data;
+
+  if (transfer.source) {
+    size = readSource(transfer);
+    buffer = mTransferBuffer;
   } else {
-      LOG->printf("file %s does not exist...\n", path.c_str());
-      result = false;
+    size = transfer.remaining<BOLBRO_TRANSFERBUDGET?transfer.remaining:BOLBRO_TRANSFERBUDGET;
+
+    //  data in memory is written without copying
+    if (buffer)
+      transfer.data += size;
+    else {
+      size = transfer.file.read(mTransferBuffer, size);
+      buffer = mTransferBuffer;
+    }
+
+    if (size==0) {
+      LOG->printf("file %s: read failed after %u bytes\n", transfer.name, (unsigned) transfer.sent);
+      return false;
+    }
+    transfer.remaining -= size;
   }
 
-  return result;
+  if (size>0&&transfer.client.write(buffer, size)!=size) {
+    LOG->printf("file %s: transfer failed after %u bytes\n", transfer.name, (unsigned) transfer.sent);
+    return false;
+  }
+
+  transfer.sent += size;
+  transfer.lastProgress = millis();
+
+  if (transfer.remaining==0)
+    LOG->printf("file %s read and sent, %u bytes\n", transfer.name, (unsigned) transfer.sent);
+
+  return transfer.remaining>0;
+}
+
+//  next portion of a source's body in mTransferBuffer, framed as a chunk unless the
+//  client talks HTTP/1.0; the empty last chunk, or no more data, completes the transfer
+#define BOLBRO_CHUNKHEADERSIZE 5 // three hex digits cover BOLBRO_TRANSFERBUDGET
+size_t BolbroWebServer::readSource(Transfer &transfer) {
+  if (!transfer.chunked) {
+    size_t size = transfer.source->read(mTransferBuffer, BOLBRO_TRANSFERBUDGET);
+
+    if (size==0)
+      transfer.remaining = 0;
+
+    return size;
+  }
+
+  uint8_t *body = mTransferBuffer+BOLBRO_CHUNKHEADERSIZE;
+  size_t size = transfer.source->read(body, BOLBRO_TRANSFERBUDGET-BOLBRO_CHUNKHEADERSIZE-2);
+  char header[BOLBRO_CHUNKHEADERSIZE+1];
+
+  snprintf(header, sizeof(header), "%03x\r\n", (unsigned) size);
+  memcpy(mTransferBuffer, header, BOLBRO_CHUNKHEADERSIZE);
+  memcpy(body+size, "\r\n", 2);
+
+  if (size==0)
+    transfer.remaining = 0;
+
+  return BOLBRO_CHUNKHEADERSIZE+size+2;
 }
 
 #endif
 
+//  the transfer's or subscriber's copy keeps the socket open, WebServer returns to
+//  waiting for new clients instead of waiting up to HTTP_MAX_CLOSE_WAIT for this one
+void BolbroWebServer::releaseClient() {
+  _currentClient = WiFiClient();
+}
+
+//  reply without Content-Length, the body is sent using chunked transfer encoding
+void BolbroWebServer::beginChunkedResponse(int code, const char *mimeType) {
+  setContentLength(CONTENT_LENGTH_UNKNOWN);
+  send(code, mimeType, "");
+}
+
+Print *BolbroWebServer::chunkedResponse() {
+  return &mChunkedResponse;
+}
+
+void BolbroWebServer::endChunkedResponse() {
+  mChunkedResponse.flush();
+  sendContent(""); // terminating chunk
+}
+
+//  the response header is written directly, WebServer would close the connection
+bool BolbroWebServer::beginEventStream(unsigned long retryMillis) {
+  for (int i = 0; i<BOLBRO_MAXSUBSCRIBERS; i++) {
+    Subscriber &subscriber = mSubscribers[i];
+
+    if (!subscriber.client.connected()) {
+      subscriber.client = client();
+      subscriber.sent = mEventLength; // from the next event on
+      subscriber.lastProgress = millis();
+      subscriber.client.print("HTTP/1.1 200 OK\r\n"
+        "Content-Type: text/event-stream\r\n"
+        "Cache-Control: no-cache\r\n"
+        "Connection: keep-alive\r\n\r\n");
+      subscriber.client.printf("retry: %lu\n\n", retryMillis);
+      releaseClient();
+
+      LOG->printf("event stream %d opened for %s\n", i, subscriber.client.remoteIP().toString().c_str());
+
+      return true;
+    }
+  }
+
+  return false;
+}
+
+//  data lines are split at '\n', EventSource joins them again
+void BolbroWebServer::sendEvent(const char *event, const char *data) {
+  //  mEvent is replaced, subscribers in the middle of the former event cannot continue
+  for (int i = 0; i<BOLBRO_MAXSUBSCRIBERS; i++)
+    if (mSubscribers[i].client.connected()&&mSubscribers[i].sent<mEventLength)
+      closeEventStream(i, "behind");
+
+  BufferPrint out(mEvent, sizeof(mEvent));
+
+  out.printf("event: %s\n", event);
+  for (const char *line = data; *line; ) {
+    const char *end = strchr(line, '\n');
+    size_t length = end?end-line:strlen(line);
+
+    out.print("data: ");
+    out.write((const uint8_t *) line, length);
+    out.print("\n");
+
+    line += end?length+1:length;
+  }
+  out.print("\n");
+
+  if (out.overflow()) {
+    LOG->printf("event %s exceeds %d bytes, not sent\n", event, BOLBRO_EVENTSIZE);
+    mEventLength = 0;
+  } else
+    mEventLength = out.length();
+
+  for (int i = 0; i<BOLBRO_MAXSUBSCRIBERS; i++) {
+    mSubscribers[i].sent = 0;
+    mSubscribers[i].lastProgress = millis();
+  }
+  continueEvents();
+
+  mLastEventMillis = millis();
+}
+
+//  next portion of the current event to each subscriber whose socket has room
+void BolbroWebServer::continueEvents() {
+  for (int i = 0; i<BOLBRO_MAXSUBSCRIBERS; i++) {
+    Subscriber &subscriber = mSubscribers[i];
+
+    if (!subscriber.client.connected()||subscriber.sent>=mEventLength)
+      continue;
+
+    if (!writable(subscriber.client)) {
+      if (millis()-subscriber.lastProgress>=BOLBRO_EVENTTIMEOUT)
+        closeEventStream(i, "stalled");
+      continue;
+    }
+
+    size_t size = mEventLength-subscriber.sent;
+
+    if (size>BOLBRO_EVENTBUDGET)
+      size = BOLBRO_EVENTBUDGET;
+
+    if (subscriber.client.write((const uint8_t *) mEvent+subscriber.sent, size)!=size) {
+      closeEventStream(i, "failed");
+      continue;
+    }
+
+    subscriber.sent += size;
+    subscriber.lastProgress = millis();
+  }
+}
+
+void BolbroWebServer::closeEventStream(int index, const char *reason) {
+  Subscriber &subscriber = mSubscribers[index];
+
+  LOG->printf("event stream %d %s, closed\n", index, reason);
+  subscriber.client.stop();
+  subscriber.client = WiFiClient();
+  subscriber.sent = 0;
+}
+
+int BolbroWebServer::numSubscribers() {
+  int numSubscribers = 0;
+
+  for (int i = 0; i<BOLBRO_MAXSUBSCRIBERS; i++)
+    if (mSubscribers[i].client.connected())
+      numSubscribers++;
+
+  return numSubscribers;
+}
+
+//  comments are ignored by EventSource, writing them detects closed connections; not
+//  written in the middle of an event
+void BolbroWebServer::keepEventStreamsAlive() {
+  if (millis()-mLastEventMillis<BOLBRO_EVENTKEEPALIVE)
+    return;
+
+  for (int i = 0; i<BOLBRO_MAXSUBSCRIBERS; i++) {
+    Subscriber &subscriber = mSubscribers[i];
+
+    if (subscriber.client.connected()&&subscriber.sent>=mEventLength
+        &&(!writable(subscriber.client)||subscriber.client.print(":\n\n")!=3))
+      closeEventStream(i, "lost");
+  }
+
+  mLastEventMillis = millis();
+}
+
+bool BolbroWebServer::notModified(const char *eTag, const char *cacheControl) {
+  //  clients revalidate on every request unless cacheControl allows otherwise
+  sendHeader("Cache-Control", cacheControl);
+  sendHeader("ETag", eTag);
+
+  if (header("If-None-Match")==eTag) {
+    send(304);
+    return true;
+  }
+
+  return false;
+}
+
+//  entries are separated by ',', parameters by ';', e.g. application/cbor;q=0.9, */*;q=0.1
+static float acceptQuality(const char *accept, const char *mimeType) {
+  const char *slash = strchr(mimeType, '/');
+  size_t typeLength = slash?slash-mimeType:strlen(mimeType);
+  int bestSpecificity = 0;
+  float quality = 0.0f;
+
+  if (!*accept)
+    return 1.0f;
+
+  for (const char *entry = accept; *entry; ) {
+    entry += strspn(entry, " \t");
+
+    const char *end = entry+strcspn(entry, ",");
+    size_t rangeLength = strcspn(entry, ";,");
+    int specificity = 0;
+    float q = 1.0f;
+
+    while (rangeLength>0&&(entry[rangeLength-1]==' '||entry[rangeLength-1]=='\t'))
+      rangeLength--;
+
+    if (rangeLength==strlen(mimeType)&&strncasecmp(entry, mimeType, rangeLength)==0)
+      specificity = 3;
+    else if (rangeLength==typeLength+2&&strncasecmp(entry, mimeType, typeLength)==0&&strncmp(entry+typeLength, "/*", 2)==0)
+      specificity = 2;
+    else if (rangeLength==3&&strncmp(entry, "*/*", 3)==0)
+      specificity = 1;
+
+    for (const char *parameter = strchr(entry, ';'); parameter&&parameter<end; parameter = strchr(parameter+1, ';')) {
+      const char *name = parameter+1+strspn(parameter+1, " \t");
+
+      if ((name[0]=='q'||name[0]=='Q')&&name[1]=='=')
+        q = atof(name+2);
+    }
+
+    if (specificity>bestSpecificity) {
+      bestSpecificity = specificity;
+      quality = q;
+    }
+
+    entry = *end?end+1:end;
+  }
+
+  return quality;
+}
+
+float BolbroWebServer::acceptQuality(const char *mimeType) {
+  return ::acceptQuality(header("Accept").c_str(), mimeType);
+}
+
 String BolbroWebServer::messageToString(String linePrefix) {
 
   String message = linePrefix + "URI: ";
@@ -212,10 +1014,17 @@ void BolbroWebServer::handleTextMessage() {
 
 void BolbroWebServer::setTextMessage(String textMessage) {
 	Bolbro.prefSetString("textMessage", textMessage);
+	strlcpy(mTextMessage, textMessage.c_str(), sizeof(mTextMessage));
+	mTextMessageLoaded = true;
 }
 
-String BolbroWebServer::textMessage() {
-	return Bolbro.prefGetString("textMessage");
+const char *BolbroWebServer::textMessage() {
+	if (!mTextMessageLoaded) {
+		strlcpy(mTextMessage, Bolbro.prefGetString("textMessage").c_str(), sizeof(mTextMessage));
+		mTextMessageLoaded = true;
+	}
+
+	return mTextMessage;
 }
 
 
@@ -8,33 +8,190 @@
 #define BolbroWebServer_h
 
 #include <Arduino.h>
+#include <Metrics.h>
+#include <JsonWriter.h>
 
 #ifdef ESP_PLATFORM // ESP32
 #	define HASSPIFFS 1
 #	include <WebServer.h>
+#	include <FS.h>
 #else
 #	define HASSPIFFS 0
 #	include <ESP8266WebServer.h>
 #	define WebServer ESP8266WebServer
 #endif
 
+//  file embedded in the firmware image, e.g. by tools/embedassets.py; data is in flash
+//  and sent as is
+struct BolbroAsset {
+  const char *path;
+  const char *mimeType;
+  const uint8_t *data;
+  uint32_t size;
+  bool gzipped; // data is gzip compressed
+  const char *eTag; // strong, quoted
+  const char *cacheControl;
+};
+
+//  embedded files indexed by a perfect hash of their path, see BolbroWebServer::hashPath()
+struct BolbroAssetTable {
+  const BolbroAsset *assets;
+  const int16_t *slots; // index into assets per hash slot, -1 if unused
+  uint16_t numSlots; // power of two
+  uint32_t seed; // chosen so that no two paths share a slot
+};
+
+//  body of unknown length produced while it is sent, see BolbroWebServer::beginTransfer();
+//  read() fills buffer with up to size bytes and returns their number, 0 once complete
+class BolbroTransferSource
+{
+  public:
+
+    virtual ~BolbroTransferSource() {}
+
+    virtual size_t read(uint8_t *buffer, size_t size) = 0;
+};
+
+//  source printing its body in pieces like one record each; printPiece() prints the next
+//  piece of at most BOLBRO_PIECESIZE bytes, false if it was the last one; read() returns
+//  early after BOLBRO_PIECEMILLIS, so a source scanning much data does not stall loop()
+#define BOLBRO_PIECESIZE 320
+#define BOLBRO_PIECEMILLIS 20
+class BolbroPrintSource : public BolbroTransferSource
+{
+  public:
+
+    BolbroPrintSource() : mOut(mPiece, sizeof(mPiece)) {
+      mPosition = 0;
+      mDone = false;
+    }
+
+    size_t read(uint8_t *buffer, size_t size);
+
+  protected:
+
+    virtual bool printPiece(Print *out) = 0;
+
+  private:
+
+    char mPiece[BOLBRO_PIECESIZE];
+    BufferPrint mOut;
+    size_t mPosition; // in mPiece, sent up to here
+    bool mDone;
+};
+
 class BolbroWebServer : public WebServer
 {
   public:
 
+    //  routes are rate limited per class, see admit()
+    enum RouteClass {
+      StaticRoute, // files
+      DynamicRoute, // generated content
+      AdminRoute, // local access only
+      NumRouteClasses
+    };
+
     BolbroWebServer();
 
+    //  FNV-1a with the high half folded in, mirrored by tools/embedassets.py
+    static uint32_t hashPath(const char *path, uint32_t seed = 0);
+
     virtual void begin();
 
+    //  serve requests and continue file transfers, call from loop()
+    void handleClient();
+
   protected:
 
+    //  exact paths dispatched by a hash lookup rather than by walking WebServer's handler
+    //  list; path has to stay valid, e.g. a literal
+#define BOLBRO_ROUTESLOTS 128 // power of two, at most three quarters are used
+#define BOLBRO_MAXROUTES (BOLBRO_ROUTESLOTS*3/4)
+    bool route(const char *path, THandlerFunction handler, RouteClass routeClass = DynamicRoute);
+
+    //  token buckets per client address and route class in a table of BOLBRO_RATECLIENTS
+    //  clients, the least recently seen is replaced; requests finding the bucket empty
+    //  are answered with 429 and Retry-After; rates in requests per minute, bursts in
+    //  requests
+#define BOLBRO_RATECLIENTS 8
+#define BOLBRO_STATICRATE 600
+#define BOLBRO_STATICBURST 60 // one page load
+#define BOLBRO_DYNAMICRATE 60
+#define BOLBRO_DYNAMICBURST 10
+#define BOLBRO_ADMINRATE 12
+#define BOLBRO_ADMINBURST 5
+    bool admit(RouteClass routeClass);
+    unsigned long admitted(RouteClass routeClass);
+    unsigned long rejected(RouteClass routeClass);
+
 #if HASSPIFFS
-    //  support to return files stored in SPIFFS
+    //  requests for files in table are answered by sendAsset() unless routed otherwise
+    void serveAssets(const BolbroAssetTable *table);
+    const BolbroAsset *findAsset(const char *path);
+
+    //  support to return files stored in SPIFFS; returnFile() replaces subStrings of up
+    //  to BOLBRO_MAXSUBSTRING characters while streaming; loadFromSpiffs() answers with
+    //  503 if busy, nothing is sent if the file does not exist; eTag and cacheControl are
+    //  sent with the file only
+#define BOLBRO_MAXSUBSTRING 64
     void returnFile(const char *path, const char *mimeType,
       int numReplacements = 0, const char **subStrings = NULL, const char **replacements = NULL);
-    bool loadFromSpiffs(String path);
+    enum TransferResult { TransferStarted, TransferBusy, TransferNotFound };
+    TransferResult loadFromSpiffs(String path, const char *eTag = NULL, const char *cacheControl = "max-age=1000");
+
+    //  files are sent by handleClient() in portions of at most BOLBRO_TRANSFERBUDGET
+    //  bytes, and only when the client's socket accepts data, so slow clients neither
+    //  block other requests nor loop(); a request finding all slots in use gets a 503
+#define BOLBRO_MAXTRANSFERS 4
+#define BOLBRO_TRANSFERBUDGET 1436 // bytes per connection and pass, one TCP segment
+#define BOLBRO_TRANSFERTIMEOUT 10000 // ms without progress until a transfer is dropped
+    bool beginTransfer(File &file);
+    bool beginTransfer(const uint8_t *data, size_t size, const char *name);
+
+    //  replies with the body produced by source, chunked for HTTP/1.1 clients, as a
+    //  download named fileName unless NULL; the server deletes source once the transfer
+    //  ended, or right away after a 503 if all slots are in use
+    bool beginTransfer(BolbroTransferSource *source, const char *mimeType, const char *name,
+      const char *fileName = NULL);
+
+    //  reply with an embedded file, 304 if the client's copy is current; gzipped files
+    //  are read from SPIFFS for clients not accepting gzip, with an ETag of their own
+    void sendAsset(const BolbroAsset &asset);
 #endif
 
+    //  chunked replies of unknown length, print to chunkedResponse() between begin and end
+#define BOLBRO_CHUNKSIZE 512
+    void beginChunkedResponse(int code, const char *mimeType);
+    Print *chunkedResponse();
+    void endChunkedResponse();
+
+    //  Server-Sent Events: beginEventStream() keeps the current request open as one of
+    //  BOLBRO_MAXSUBSCRIBERS subscriptions, false if all are in use; sendEvent() formats
+    //  the event once, handleClient() writes it to the subscribers in portions whenever
+    //  their socket accepts data; subscribers still behind when the next event is sent,
+    //  or stalled, are dropped, they reconnect
+#define BOLBRO_MAXSUBSCRIBERS 4
+#define BOLBRO_EVENTKEEPALIVE 15000 // ms between comments keeping idle streams open
+#define BOLBRO_EVENTSIZE 2048 // formatted event, data lines prefixed
+#define BOLBRO_EVENTBUDGET 1436 // bytes per subscriber and pass, one TCP segment
+#define BOLBRO_EVENTTIMEOUT 10000 // ms without progress until a subscriber is dropped
+    bool beginEventStream(unsigned long retryMillis);
+    void sendEvent(const char *event, const char *data);
+    int numSubscribers();
+
+    //  conditional requests: sends the ETag header, and replies 304 returning true in case
+    //  the client's If-None-Match matches eTag; otherwise the caller replies as usual
+    bool notModified(const char *eTag, const char *cacheControl = "no-cache");
+
+    //  q value of the most specific Accept entry matching mimeType, 1 without Accept
+    //  header, 0 if no entry matches
+    float acceptQuality(const char *mimeType);
+
+    //  /metrics in Prometheus text format: heap, rate limits, openHAB errors, and latency
+    //  histograms per route; subclasses add their own metrics after calling this one
+    virtual void writeMetrics(Print *out);
+
     //  debug support
     String messageToString(String linePrefix = "");
 
@@ -53,8 +210,173 @@ class BolbroWebServer : public WebServer
 
 	//	store text message
 	void handleTextMessage();
+#define BOLBRO_TEXTMESSAGESIZE 256
 	void setTextMessage(String textMessage);
-	String textMessage();
+	const char *textMessage(); // cached, no preferences access per request
+
+  private:
+
+    //  collects output in chunks of BOLBRO_CHUNKSIZE bytes to be sent to the client
+    class ChunkedResponse : public Print
+    {
+      public:
+
+        ChunkedResponse(WebServer *server) {
+          mServer = server;
+          mLength = 0;
+        }
+
+        size_t write(uint8_t c) {
+          if (mLength>=BOLBRO_CHUNKSIZE)
+            flush();
+          mBuffer[mLength++] = c;
+          return 1;
+        }
+
+        void flush() {
+          if (mLength>0)
+            mServer->sendContent((const char *) mBuffer, mLength);
+          mLength = 0;
+        }
+
+      private:
+
+        WebServer *mServer;
+        uint8_t mBuffer[BOLBRO_CHUNKSIZE];
+        size_t mLength;
+    };
+
+    ChunkedResponse mChunkedResponse;
+
+    struct Route {
+      const char *path; // NULL if the slot is unused
+      uint32_t hash;
+      uint8_t routeClass;
+      uint8_t latency; // index into mRouteLatency
+      THandlerFunction handler;
+    };
+
+    Route mRoutes[BOLBRO_ROUTESLOTS];
+    int mNumRoutes;
+    const BolbroAssetTable *mAssets;
+
+    LatencyHistogram mRouteLatency[BOLBRO_MAXROUTES]; // in order of route()
+    LatencyHistogram mAssetLatency; // all of mAssets
+
+    void handleMetrics();
+
+    struct RateClient {
+      uint32_t address; // IPv4, 0 if unused
+      unsigned long lastSeen; // ms
+      uint32_t milliTokens[NumRouteClasses];
+    };
+
+    RateClient mRateClients[BOLBRO_RATECLIENTS];
+    unsigned long mAdmitted[NumRouteClasses];
+    unsigned long mRejected[NumRouteClasses];
+
+    void handleRateLimits();
+
+    Route *findRoute(const char *path, uint32_t hash);
+
+    //  the only handler added to WebServer, dispatches to mRoutes and mAssets
+    class RouteHandler : public RequestHandler
+    {
+      public:
+
+        RouteHandler(BolbroWebServer *server) {
+          mServer = server;
+          mRoute = NULL;
+          mAsset = NULL;
+        }
+
+        bool canHandle(HTTPMethod method, String uri) {
+          const char *path = uri.c_str();
+
+          mRoute = mServer->findRoute(path, hashPath(path));
+          mAsset = NULL;
+#if HASSPIFFS
+          if (!mRoute)
+            mAsset = mServer->findAsset(path);
+#endif
+          return mRoute||mAsset;
+        }
+
+        bool handle(WebServer &server, HTTPMethod requestMethod, String requestUri) {
+          unsigned long start = LatencyHistogram::start();
+
+          if (!mServer->admit(mRoute?(RouteClass) mRoute->routeClass:StaticRoute))
+            return true; // answered with 429
+          else if (mRoute) {
+            mRoute->handler();
+            mServer->mRouteLatency[mRoute->latency].observe(start);
+          }
+#if HASSPIFFS
+          else if (mAsset) {
+            mServer->sendAsset(*mAsset);
+            mServer->mAssetLatency.observe(start);
+          }
+#endif
+          else
+            return false;
+
+          return true;
+        }
+
+      private:
+
+        BolbroWebServer *mServer;
+        Route *mRoute; // found by canHandle(), called by handle()
+        const BolbroAsset *mAsset;
+    };
+
+    struct Subscriber {
+      WiFiClient client; // a copy keeps the connection open after the handler returned
+      size_t sent; // bytes of mEvent, mEventLength once complete
+      unsigned long lastProgress;
+    };
+
+    Subscriber mSubscribers[BOLBRO_MAXSUBSCRIBERS];
+    char mEvent[BOLBRO_EVENTSIZE];
+    size_t mEventLength;
+    unsigned long mLastEventMillis;
+
+    void keepEventStreamsAlive();
+    void continueEvents();
+    void closeEventStream(int index, const char *reason);
+
+#if HASSPIFFS
+    struct Transfer {
+      bool active;
+      WiFiClient client; // a copy keeps the connection open after the handler returned
+      const char *name;
+      File file;
+      const uint8_t *data; // sent from memory if not NULL, from file otherwise
+      BolbroTransferSource *source; // sent from source if not NULL, owned
+      bool chunked; // source's output is framed as chunks
+      size_t remaining; // 1 for a source until it is complete
+      size_t sent;
+      unsigned long lastProgress;
+    };
+
+    Transfer mTransfers[BOLBRO_MAXTRANSFERS];
+    uint8_t mTransferBuffer[BOLBRO_TRANSFERBUDGET]; // shared, transfers run one at a time
+
+    Transfer *reserveTransfer(const char *name);
+    void continueTransfers();
+    bool continueTransfer(Transfer &transfer);
+    size_t readSource(Transfer &transfer);
+
+    //  503 for a request finding all slots in use, not to be cached
+    void sendBusy(const char *name);
+#endif
+
+    //  after handing the connection over to a transfer or an event stream; WebServer would
+    //  not accept further requests until the client closes it otherwise
+    void releaseClient();
+
+    char mTextMessage[BOLBRO_TEXTMESSAGESIZE];
+    bool mTextMessageLoaded;
 };
 
 #endif
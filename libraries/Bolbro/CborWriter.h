@@ -0,0 +1,281 @@
+/* --------------------------------------------------------------------------------
+	CborWriter
+	Streaming CBOR (RFC 8949) output to any Print, member for member interchangeable
+	with JsonWriter; maps, arrays, and strings written in parts use indefinite lengths
+	so nothing has to be counted or buffered, undefined values are null, timestamps
+	epoch seconds (tag 1); select() restricts output to some members, e.g. for
+	?fields=weather.temperature,aggregated
+	Harald Schlangmann, October 2026
+   -------------------------------------------------------------------------------- */
+
+#ifndef CborWriter_h
+#define CborWriter_h
+
+#include <Arduino.h>
+#include <math.h>
+
+#define CBORWRITER_MAXDEPTH 8
+#define CBORWRITER_MAXPATH 64 // member path like aggregated.rainday
+
+#define CBOR_FALSE 0xf4
+#define CBOR_TRUE 0xf5
+#define CBOR_NULL 0xf6
+#define CBOR_FLOAT32 0xfa
+#define CBOR_BREAK 0xff
+
+class CborWriter
+{
+	public:
+
+		CborWriter(Print *out) {
+			mOut = out;
+			mDepth = 0;
+			mSkipDepth = 0;
+			mOverflowDepth = 0;
+			mAll[0] = true;
+			mPathLength[0] = 0;
+			mFields = NULL;
+			mInString = false;
+		}
+
+		//	comma separated member paths, members of objects selected are included, NULL or
+		//	empty for all; fields has to stay valid while writing
+		void select(const char *fields) {
+			mFields = fields&&*fields?fields:NULL;
+			mAll[0] = !mFields;
+		}
+
+		void beginObject(const char *name = NULL) {
+			beginContainer(name, 0xbf);
+		}
+
+		void endObject() {
+			endContainer();
+		}
+
+		void beginArray(const char *name = NULL) {
+			beginContainer(name, 0x9f);
+		}
+
+		void endArray() {
+			endContainer();
+		}
+
+		//	rounded to precision, an integer in case of no decimals, null unless valid
+		void number(const char *name, float value, int precision, bool valid) {
+			if (!member(name, false))
+				return;
+
+			if (!valid||isnan(value)||isinf(value))
+				mOut->write(CBOR_NULL);
+			else if (precision<=0)
+				writeInteger(lroundf(value));
+			else {
+				float scale = powf(10.0f, precision);
+				uint32_t bits;
+
+				value = roundf(value*scale)/scale;
+				memcpy(&bits, &value, sizeof(bits));
+				mOut->write(CBOR_FLOAT32);
+				for (int shift = 24; shift>=0; shift -= 8)
+					mOut->write((uint8_t) (bits>>shift));
+			}
+		}
+
+		void number(const char *name, long value) {
+			if (member(name, false))
+				writeInteger(value);
+		}
+
+		//	null in case value is NULL
+		void string(const char *name, const char *value) {
+			if (!member(name, false))
+				return;
+
+			if (value)
+				writeText(value);
+			else
+				mOut->write(CBOR_NULL);
+		}
+
+		void boolean(const char *name, bool value) {
+			if (member(name, false))
+				mOut->write(value?CBOR_TRUE:CBOR_FALSE);
+		}
+
+		void undefined(const char *name) {
+			if (member(name, false))
+				mOut->write(CBOR_NULL);
+		}
+
+		//	epoch seconds rather than text, null if 0
+		void timestamp(const char *name, time_t value, const char * /* text */) {
+			if (!member(name, false))
+				return;
+
+			if (value) {
+				mOut->write(0xc1);
+				writeInteger((long) value);
+			} else
+				mOut->write(CBOR_NULL);
+		}
+
+		//	a string value written in parts
+		void beginString(const char *name) {
+			mInString = member(name, false);
+			if (mInString)
+				mOut->write(0x7f);
+		}
+
+		void appendString(const char *part) {
+			if (mInString&&*part)
+				writeText(part);
+		}
+
+		void endString() {
+			if (mInString)
+				mOut->write(CBOR_BREAK);
+			mInString = false;
+		}
+
+	private:
+
+		Print *mOut;
+		int mDepth;
+		int mSkipDepth; // containers not selected we are in
+		int mOverflowDepth; // containers beyond CBORWRITER_MAXDEPTH we are in
+		bool mAll[CBORWRITER_MAXDEPTH+1]; // all members on this level are selected
+		char mPath[CBORWRITER_MAXPATH];
+		size_t mPathLength[CBORWRITER_MAXDEPTH+1];
+		const char *mFields;
+		bool mInString;
+
+		//	major type and argument in the shortest form
+		void writeHead(uint8_t majorType, uint32_t value) {
+			majorType <<= 5;
+			if (value<24)
+				mOut->write(majorType|value);
+			else if (value<0x100) {
+				mOut->write(majorType|24);
+				mOut->write((uint8_t) value);
+			} else if (value<0x10000) {
+				mOut->write(majorType|25);
+				mOut->write((uint8_t) (value>>8));
+				mOut->write((uint8_t) value);
+			} else {
+				mOut->write(majorType|26);
+				for (int shift = 24; shift>=0; shift -= 8)
+					mOut->write((uint8_t) (value>>shift));
+			}
+		}
+
+		void writeInteger(long value) {
+			if (value<0)
+				writeHead(1, (uint32_t) (-1-value));
+			else
+				writeHead(0, (uint32_t) value);
+		}
+
+		void writeText(const char *s) {
+			size_t length = strlen(s);
+
+			writeHead(3, length);
+			mOut->write((const uint8_t *) s, length);
+		}
+
+		//	2 if path is selected, 1 if members below are, 0 otherwise
+		int selection(const char *path, size_t length) {
+			int result = 0;
+
+			for (const char *field = mFields; field; field = strchr(field, ',')) {
+				if (*field==',')
+					field++;
+
+				size_t fieldLength = strcspn(field, ",");
+
+				if (fieldLength>=length&&strncmp(field, path, length)==0) {
+					if (fieldLength==length)
+						return 2;
+					if (field[length]=='.')
+						result = 1;
+				}
+			}
+
+			return result;
+		}
+
+		//	decides if the next member is written, and writes its key if so; the path of a
+		//	container selected is kept for its members
+		bool member(const char *name, bool container) {
+			bool all = mAll[mDepth];
+
+			if (mSkipDepth)
+				return false;
+
+			//	no selection state that deep, all members of a container written are
+			if (mOverflowDepth) {
+				if (name)
+					writeText(name);
+				return true;
+			}
+
+			if (!all&&mDepth>0) {
+				if (!name)
+					return false;
+
+				size_t base = mPathLength[mDepth];
+				size_t length = base+(base?1:0)+strlen(name);
+
+				if (length>=CBORWRITER_MAXPATH)
+					return false;
+				if (base)
+					mPath[base] = '.';
+				strcpy(mPath+base+(base?1:0), name);
+
+				int selected = selection(mPath, length);
+
+				if (selected==0||(selected==1&&!container))
+					return false;
+				all = selected==2;
+				if (container&&mDepth<CBORWRITER_MAXDEPTH)
+					mPathLength[mDepth+1] = length;
+			} else if (container&&mDepth<CBORWRITER_MAXDEPTH)
+				mPathLength[mDepth+1] = 0;
+
+			if (container&&mDepth<CBORWRITER_MAXDEPTH)
+				mAll[mDepth+1] = all;
+
+			if (name&&mDepth>0)
+				writeText(name);
+
+			return true;
+		}
+
+		void beginContainer(const char *name, uint8_t initialByte) {
+			if (!member(name, true)) {
+				mSkipDepth++;
+				return;
+			}
+
+			mOut->write(initialByte);
+			if (mDepth<CBORWRITER_MAXDEPTH)
+				mDepth++;
+			else
+				mOverflowDepth++;
+		}
+
+		void endContainer() {
+			if (mSkipDepth) {
+				mSkipDepth--;
+				return;
+			}
+
+			mOut->write(CBOR_BREAK);
+			if (mOverflowDepth)
+				mOverflowDepth--;
+			else if (mDepth>0)
+				mDepth--;
+		}
+};
+
+#endif
@@ -0,0 +1,246 @@
+/* --------------------------------------------------------------------------------
+	JsonWriter
+	Streaming JSON output to any Print, e.g. a chunked response or a BufferPrint on
+	the stack; nothing is allocated on the heap, strings are escaped, and undefined
+	values are written as STRINGNOTINITIALIZED ("-")
+	Harald Schlangmann, October 2026
+   -------------------------------------------------------------------------------- */
+
+#ifndef JsonWriter_h
+#define JsonWriter_h
+
+#include <Arduino.h>
+#include <math.h>
+
+#define JSONWRITER_MAXDEPTH 8
+#define JSONWRITER_UNDEFINED "-" // matches STRINGNOTINITIALIZED
+
+//	Print into a fixed buffer, always zero terminated; output not fitting is dropped
+//	and flagged
+class BufferPrint : public Print
+{
+	public:
+
+		using Print::write;
+
+		BufferPrint(char *buffer, size_t size) {
+			mBuffer = buffer;
+			mSize = size;
+			reset();
+		}
+
+		void reset() {
+			mLength = 0;
+			mBuffer[0] = '\0';
+			mOverflow = false;
+		}
+
+		size_t write(uint8_t c) {
+			if (mLength+1>=mSize) {
+				mOverflow = true;
+				return 0;
+			}
+
+			mBuffer[mLength++] = c;
+			mBuffer[mLength] = '\0';
+
+			return 1;
+		}
+
+		size_t write(const uint8_t *bytes, size_t size) {
+			size_t numWritten = 0;
+
+			while (numWritten<size&&write(bytes[numWritten]))
+				numWritten++;
+
+			return numWritten;
+		}
+
+		const char *c_str() {
+			return mBuffer;
+		}
+
+		size_t length() {
+			return mLength;
+		}
+
+		bool overflow() {
+			return mOverflow;
+		}
+
+	private:
+
+		char *mBuffer;
+		size_t mSize, mLength;
+		bool mOverflow;
+};
+
+//	pretty printed like the hand written producers before, one member per line and
+//	tabs for indentation; names are NULL within arrays and for the outermost container
+class JsonWriter
+{
+	public:
+
+		JsonWriter(Print *out) {
+			mOut = out;
+			mDepth = 0;
+			mOverflowDepth = 0;
+			mFirst[0] = true;
+			mInString = false;
+		}
+
+		void beginObject(const char *name = NULL) {
+			beginContainer(name, '{');
+		}
+
+		void endObject() {
+			endContainer('}');
+		}
+
+		void beginArray(const char *name = NULL) {
+			beginContainer(name, '[');
+		}
+
+		void endArray() {
+			endContainer(']');
+		}
+
+		//	fixed number of decimals, "-" unless valid or not a number
+		void number(const char *name, float value, int precision, bool valid) {
+			char buffer[32];
+
+			if (!valid||isnan(value)||isinf(value)) {
+				undefined(name);
+				return;
+			}
+
+			member(name);
+			snprintf(buffer, sizeof(buffer), "%.*f", precision, value);
+			mOut->print(buffer);
+		}
+
+		void number(const char *name, long value) {
+			char buffer[16];
+
+			member(name);
+			snprintf(buffer, sizeof(buffer), "%ld", value);
+			mOut->print(buffer);
+		}
+
+		//	"-" in case value is NULL
+		void string(const char *name, const char *value) {
+			member(name);
+			mOut->write('"');
+			escape(value?value:JSONWRITER_UNDEFINED);
+			mOut->write('"');
+		}
+
+		void boolean(const char *name, bool value) {
+			member(name);
+			mOut->print(value?"true":"false");
+		}
+
+		void undefined(const char *name) {
+			string(name, NULL);
+		}
+
+		//	text given, "-" if value is 0; see CborWriter
+		void timestamp(const char *name, time_t value, const char *text) {
+			string(name, value?text:NULL);
+		}
+
+		//	a string value written in parts
+		void beginString(const char *name) {
+			member(name);
+			mOut->write('"');
+			mInString = true;
+		}
+
+		void appendString(const char *part) {
+			if (mInString)
+				escape(part);
+		}
+
+		void endString() {
+			mOut->write('"');
+			mInString = false;
+		}
+
+	private:
+
+		Print *mOut;
+		int mDepth;
+		int mOverflowDepth; // containers beyond JSONWRITER_MAXDEPTH we are in, not indented
+		bool mFirst[JSONWRITER_MAXDEPTH+1]; // no member written on this level yet
+		bool mInString;
+
+		void indent() {
+			for (int i = 0; i<mDepth; i++)
+				mOut->write('\t');
+		}
+
+		//	separator, indentation, and name of the next member
+		void member(const char *name) {
+			if (mDepth>0) {
+				mOut->print(mFirst[mDepth]?"\n":",\n");
+				indent();
+			}
+			mFirst[mDepth] = false;
+
+			if (name) {
+				mOut->write('"');
+				escape(name);
+				mOut->print("\" : ");
+			}
+		}
+
+		void beginContainer(const char *name, char bracket) {
+			member(name);
+			mOut->write(bracket);
+
+			if (mDepth<JSONWRITER_MAXDEPTH)
+				mDepth++;
+			else
+				mOverflowDepth++;
+			mFirst[mDepth] = true;
+		}
+
+		void endContainer(char bracket) {
+			bool empty = mFirst[mDepth];
+
+			//	levels beyond share mFirst, the enclosing one has this container at least
+			if (mOverflowDepth) {
+				mOverflowDepth--;
+				mFirst[mDepth] = false;
+			} else if (mDepth>0)
+				mDepth--;
+
+			if (!empty) {
+				mOut->write('\n');
+				indent();
+			}
+			mOut->write(bracket);
+
+			if (mDepth==0)
+				mOut->write('\n');
+		}
+
+		void escape(const char *s) {
+			for (; *s; s++) {
+				char c = *s;
+
+				if (c=='"'||c=='\\') {
+					mOut->write('\\');
+					mOut->write(c);
+				} else if ((uint8_t) c<0x20) {
+					char buffer[8];
+
+					snprintf(buffer, sizeof(buffer), "\\u%04x", (uint8_t) c);
+					mOut->print(buffer);
+				} else
+					mOut->write(c);
+			}
+		}
+};
+
+#endif
@@ -0,0 +1,91 @@
+/* --------------------------------------------------------------------------------
+	Metrics
+	Latency histograms with fixed buckets, and output in Prometheus text format;
+	observing a sample costs a micros() call and at most nine compares
+	Harald Schlangmann, October 2026
+   -------------------------------------------------------------------------------- */
+
+#ifndef Metrics_h
+#define Metrics_h
+
+#include <Arduino.h>
+
+#define METRICS_NUMBUCKETS 10 // including +Inf
+#define METRICS_CONTENTTYPE "text/plain; version=0.0.4"
+
+//	counts of samples per bucket, cumulated when written; micros() rather than the cycle
+//	counter, so samples like openHAB timeouts longer than its wrap around are measured
+class LatencyHistogram
+{
+	public:
+
+		LatencyHistogram() {
+			for (int i = 0; i<METRICS_NUMBUCKETS; i++)
+				mBuckets[i] = 0;
+			mCount = 0;
+			mSumMicros = 0;
+		}
+
+		//	upper bounds in microseconds, last is +Inf
+		static uint32_t bound(int bucket) {
+			static const uint32_t bounds[METRICS_NUMBUCKETS-1] = {
+				100, 1000, 5000, 10000, 50000, 100000, 500000, 1000000, 5000000
+			};
+
+			return bounds[bucket];
+		}
+
+		static unsigned long start() {
+			return micros();
+		}
+
+		//	record the time passed since start()
+		void observe(unsigned long startMicros) {
+			unsigned long elapsed = micros()-startMicros;
+			int bucket = 0;
+
+			while (bucket<METRICS_NUMBUCKETS-1&&elapsed>bound(bucket))
+				bucket++;
+
+			mBuckets[bucket]++;
+			mCount++;
+			mSumMicros += elapsed;
+		}
+
+		unsigned long count() {
+			return mCount;
+		}
+
+		//	HELP and TYPE lines, once per metric before the histograms of all label sets
+		static void writeHeader(Print *out, const char *name, const char *help) {
+			out->printf("# HELP %s %s\n# TYPE %s histogram\n", name, help, name);
+		}
+
+		//	labels are written as given, e.g. stage="calcSun"
+		void write(Print *out, const char *name, const char *labels) {
+			unsigned long cumulated = 0;
+
+			for (int i = 0; i<METRICS_NUMBUCKETS; i++) {
+				cumulated += mBuckets[i];
+				if (i<METRICS_NUMBUCKETS-1)
+					out->printf("%s_bucket{%s,le=\"%g\"} %lu\n", name, labels, bound(i)/1e6, cumulated);
+				else
+					out->printf("%s_bucket{%s,le=\"+Inf\"} %lu\n", name, labels, cumulated);
+			}
+			out->printf("%s_sum{%s} %.6f\n", name, labels, mSumMicros/1e6);
+			out->printf("%s_count{%s} %lu\n", name, labels, mCount);
+		}
+
+	private:
+
+		unsigned long mBuckets[METRICS_NUMBUCKETS];
+		unsigned long mCount;
+		uint64_t mSumMicros;
+};
+
+//	counter or gauge without labels
+inline void writeMetric(Print *out, const char *name, const char *type, const char *help, double value) {
+	out->printf("# HELP %s %s\n# TYPE %s %s\n%s %.15g\n", name, help, name, type, name, value);
+}
+
+#endif
@@ -6,6 +6,7 @@
 #define _CALIBRATIONPACKET_H_
 
 #include <Bolbro.h>
+#include <JsonWriter.h>
 #include <Packet.h>
 #include <WeatherConfig.h>
 
@@ -146,24 +147,22 @@ class CalibrationPacket : public Packet {
 			p->println(mCRC16==crc16()?" correct":" wrong");
     }
 
-		String json(String message = "", String linePrefix = "") {
-
-      String json = linePrefix + "{\n";
-
-      json += linePrefix + "\t\"bucketVol\" : " + String(mBucketTriggerVolume, 1) +",\n";
-      json += linePrefix + "\t\"speedFactor\" : " + String(mWindSpeedFactor, 2) +",\n";
-      json += linePrefix + "\t\"height\" : " + String(mMeasurementHeight, 2) +",\n";
-      json += linePrefix + "\t\"inclination\" : " + String(mInclination, 1) +",\n";
-      json += linePrefix + "\t\"azimuth\" : " + String(mAzimuth, 1) +",\n";
-      json += linePrefix + "\t\"reportSecs\" : " + String(mSecondsBetweenReports) +",\n";
-      if (message.length()>0)
-      	json += linePrefix + "\t\"message\" : \"" + String(message) +"\",\n";
-      json += linePrefix + "\t\"command\" : " + String(mCommand) +"\n";
-
-      json += linePrefix + "}";
-
-      return json;
-    }
+		//	message is omitted if NULL or empty
+		void json(JsonWriter &json, const char *message = NULL) {
+			json.beginObject();
+
+			json.number("bucketVol", mBucketTriggerVolume, 1, true);
+			json.number("speedFactor", mWindSpeedFactor, 2, true);
+			json.number("height", mMeasurementHeight, 2, true);
+			json.number("inclination", mInclination, 1, true);
+			json.number("azimuth", mAzimuth, 1, true);
+			json.number("reportSecs", (long) mSecondsBetweenReports);
+			if (message&&message[0])
+				json.string("message", message);
+			json.number("command", (long) mCommand);
+
+			json.endObject();
+		}
 
   protected:
 
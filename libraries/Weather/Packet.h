@@ -48,7 +48,17 @@ class Packet {
     //  internal write status for decodeByte(), not included in encoded packet
     uint8_t mDecodePos;
 
-    uint16_t crc16(uint8_t* data_p, uint16_t length) {
+    //  not a member, a member would move mMagicByte and change the encoded layout
+    static unsigned long &numCRCFailures() {
+      static unsigned long numCRCFailures = 0;
+
+      return numCRCFailures;
+    }
+
+  public:
+
+    //  CRC-16/CCITT-FALSE, public for tools decoding captured packets
+    static uint16_t crc16(const uint8_t* data_p, uint16_t length) {
       unsigned char x;
       uint16_t crc = 0xFFFF;
 
@@ -120,6 +130,7 @@ class Packet {
             return true;
           } else {
             //  corrupted packet, reset
+            numCRCFailures()++;
             if (DEBUG)
               LOG->println("decoded to a corrupted packet, skipping...");
             return false;
@@ -129,6 +140,11 @@ class Packet {
           return false;
       }
     }
+
+    //  complete packets received with a wrong checksum, by all packets decoded
+    static unsigned long crcFailures() {
+      return numCRCFailures();
+    }
 };
 
 #endif // _PACKET_H_
\ No newline at end of file
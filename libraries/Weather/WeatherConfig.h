@@ -27,6 +27,7 @@
 //	for sun position calculation and weather forecast
 #define LATITUDE (54.0+49.361/60.0) // customize
 #define LONGITUDE (9.0+36.987/60.0) // customize
+#define ALTITUDE 10.0 // customize, meters above sea level, reduces pressure to sea level for the local forecast
 
 //  wind vane and anemometer
 #if USE_WIND_AS5600
@@ -69,6 +70,8 @@
 #if USE_RAIN
 #define RAIN_PIN 27
 #endif // USE_RAIN
+#define RAIN_GAUGE_DIAMETER 106.0 // mm
+#define MAX_RAIN_TIPS 6 // tip times sent per report
 // 	8 pulses = 25ml, one bucket = 3.125ml
 #define DEFAULT_BUCKET_TRIGGER_VOLUME 3125.0f // 3.125ml = 3125m3;
 
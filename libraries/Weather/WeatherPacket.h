@@ -6,6 +6,7 @@
 #define _WEATHERPACKET_H_
 
 #include <Bolbro.h>
+#include <JsonWriter.h>
 #include <Packet.h>
 
 class WeatherPacket : public Packet {
@@ -34,6 +35,11 @@ class WeatherPacket : public Packet {
     //  system voltage, usually the battery
     float mBatteryVoltage;
 
+    //  rain gauge tips since the last report (mDeltaRainMM), and the age of the most recent
+    //  ones in 1/10 s before the report, most recent first
+    uint8_t mNumRainTips;
+    uint16_t mRainTipAges[MAX_RAIN_TIPS];
+
   private:
 
     //  CRC16 checksum
@@ -52,6 +58,14 @@ class WeatherPacket : public Packet {
       mWindSpeedMpS = UNDEFINEDVALUE;
 
       mBatteryVoltage = UNDEFINEDVALUE;
+
+      mNumRainTips = 0;
+      memset(mRainTipAges, 0, sizeof(mRainTipAges));
+    }
+
+    //  number of tips with mRainTipAges set
+    int numRainTipAges() {
+      return mNumRainTips<MAX_RAIN_TIPS?mNumRainTips:MAX_RAIN_TIPS;
     }
 
 		float batteryPercentage() {
@@ -85,6 +99,26 @@ class WeatherPacket : public Packet {
 			return batteryPercentage;
 		}
 
+    //  the 16 wind directions as used by the wind vane, clockwise starting with north
+    static const char *windDirectionName(int index) {
+      static const char *directions[] =
+        {
+          "N", "NNE", "NE", "ENE", "E", "ESE", "SE", "SSE",
+          "S", "SSW", "SW", "WSW", "W", "WNW", "NW", "NNW"
+        };
+
+      return index>=0&&index<16?directions[index]:"";
+    }
+
+    //  index of mWindDirection in windDirectionName(), -1 if undefined
+    int windDirectionIndex() {
+      for (int i = 0; i<16; i++)
+        if (strcmp(mWindDirection, windDirectionName(i))==0)
+          return i;
+
+      return -1;
+    }
+
     void print(Print *p) {
     	p->print("magic byte: ");
 			p->print(mMagicByte);
@@ -96,6 +130,17 @@ class WeatherPacket : public Packet {
         p->print(mDeltaRainMM, 1);
       	p->println(" mm delta");
       }
+
+			if (mNumRainTips>0) {
+				p->print("rain tips: ");
+				p->print(mNumRainTips);
+				p->print(", ages");
+				for (int i = 0; i<numRainTipAges(); i++) {
+					p->print(" ");
+					p->print(mRainTipAges[i]/10.0, 1);
+				}
+				p->println(" s");
+			}
 #endif // USE_RAIN
 
 #if USE_TEMPERATURE
@@ -142,82 +187,20 @@ class WeatherPacket : public Packet {
 			p->println(mCRC16==crc16()?" correct":" wrong");
     }
 
-#define STRING_WORKAROUND 1
-
-#if STRING_WORKAROUND
-		const char *jsonLine(const char *name, bool valid, float value, int precision, bool closingComma = true) {
-			static char buffer[128];
-
-			if (valid)
-				snprintf(buffer, 128, "\t\"%s\" : %.*f%s\n", name, precision, value, closingComma?",":"");
-			else
-				snprintf(buffer, 128, "\t\"%s\" : \"%s\"%s\n", name, STRINGNOTINITIALIZED, closingComma?",":"");
-
-			return buffer;
-		}
-#endif
-
-    String json(String linePrefix = "") {
-
-      String json = linePrefix + "{\n";
-
-#if STRING_WORKAROUND
-			json += linePrefix + jsonLine("raindelta", mDeltaRainMM!=UNDEFINEDVALUE, mDeltaRainMM, 1);
-			json += linePrefix + jsonLine("temperature", mTemperatureDegreeCelsius!=UNDEFINEDVALUE, mTemperatureDegreeCelsius, 1);
-			json += linePrefix + jsonLine("humidity", mHumidityPercent!=UNDEFINEDVALUE, mHumidityPercent, 1);
-			json += linePrefix + jsonLine("pressure", mPressureHPA!=UNDEFINEDVALUE, mPressureHPA, 1);
-
-      if (mWindDirection[0])
-        json += linePrefix + "\t\"winddirection\" : \"" + String(mWindDirection) +"\",\n";
-      else
-        json += linePrefix + "\t\"winddirection\" : \"" STRINGNOTINITIALIZED "\",\n";
-
-			json += linePrefix + jsonLine("windspeed", mWindSpeedMpS!=UNDEFINEDVALUE, mWindSpeedMpS, 1);
-			json += linePrefix + jsonLine("batteryvoltage", mBatteryVoltage!=UNDEFINEDVALUE, mBatteryVoltage, 2);
-			json += linePrefix + jsonLine("batterypercentage", mBatteryVoltage!=UNDEFINEDVALUE, batteryPercentage(), 0, false);
-#else
-      if (mDeltaRainMM!=UNDEFINEDVALUE)
-        json += linePrefix + "\t\"raindelta\" : " + String(mDeltaRainMM, 1) +",\n";
-      else
-        json += linePrefix + "\t\"raindelta\" : \"" STRINGNOTINITIALIZED "\",\n";
-
-      if (mTemperatureDegreeCelsius!=UNDEFINEDVALUE)
-        json += linePrefix + "\t\"temperature\" : " + String(mTemperatureDegreeCelsius, 1) +",\n";
-      else
-        json += linePrefix + "\t\"temperature\" : \"" STRINGNOTINITIALIZED "\",\n";
-
-      if (mHumidityPercent!=UNDEFINEDVALUE)
-        json += linePrefix + "\t\"humidity\" : " + String(mHumidityPercent, 1) +",\n";
-      else
-        json += linePrefix + "\t\"humidity\" : \"" STRINGNOTINITIALIZED "\",\n";
-
-      if (mPressureHPA!=UNDEFINEDVALUE)
-        json += linePrefix + "\t\"pressure\" : " + String(mPressureHPA, 1) +",\n";
-      else
-        json += linePrefix + "\t\"pressure\" : \"" STRINGNOTINITIALIZED "\",\n";
-
-      if (mWindDirection[0])
-        json += linePrefix + "\t\"winddirection\" : \"" + String(mWindDirection) +"\",\n";
-      else
-        json += linePrefix + "\t\"winddirection\" : \"" STRINGNOTINITIALIZED "\",\n";
-
-      if (mWindSpeedMpS!=UNDEFINEDVALUE)
-        json += linePrefix + "\t\"windspeed\" : " + String(mWindSpeedMpS, 1) +",\n";
-      else
-        json += linePrefix + "\t\"windspeed\" : \"" STRINGNOTINITIALIZED "\",\n";
-
-      if (mBatteryVoltage!=UNDEFINEDVALUE) {
-        json += linePrefix + "\t\"batteryvoltage\" : " + String(mBatteryVoltage, 2) +",\n";
-        json += linePrefix + "\t\"batterypercentage\" : " + String(batteryPercentage(), 0) +"\n";
-      } else {
-        json += linePrefix + "\t\"batteryvoltage\" : \"" STRINGNOTINITIALIZED "\",\n";
-        json += linePrefix + "\t\"batterypercentage\" : \"" STRINGNOTINITIALIZED "\"\n";
-      }
-#endif
+    //  one member per value, "-" if undefined; JsonWriter or CborWriter
+    template <class Writer> void json(Writer &json, const char *name = NULL) {
+      json.beginObject(name);
 
-      json += linePrefix + "}";
+      json.number("raindelta", mDeltaRainMM, 1, mDeltaRainMM!=UNDEFINEDVALUE);
+      json.number("temperature", mTemperatureDegreeCelsius, 1, mTemperatureDegreeCelsius!=UNDEFINEDVALUE);
+      json.number("humidity", mHumidityPercent, 1, mHumidityPercent!=UNDEFINEDVALUE);
+      json.number("pressure", mPressureHPA, 1, mPressureHPA!=UNDEFINEDVALUE);
+      json.string("winddirection", mWindDirection[0]?mWindDirection:NULL);
+      json.number("windspeed", mWindSpeedMpS, 1, mWindSpeedMpS!=UNDEFINEDVALUE);
+      json.number("batteryvoltage", mBatteryVoltage, 2, mBatteryVoltage!=UNDEFINEDVALUE);
+      json.number("batterypercentage", batteryPercentage(), 0, mBatteryVoltage!=UNDEFINEDVALUE);
 
-      return json;
+      json.endObject();
     }
 
   protected:
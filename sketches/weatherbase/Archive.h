@@ -0,0 +1,319 @@
+/* --------------------------------------------------------------------------------
+ *  Archive
+ *  long term archive of all readings received, stored on SPIFFS in fixed size
+ *  blocks (see ArchiveBlock.h); the current block is kept in memory and written
+ *  back once full or every ARCHIVE_FLUSHSECONDS
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+#include <SPIFFS.h>
+#include <WeatherPacket.h>
+
+#include "ArchiveBlock.h"
+
+#define ARCHIVE_PATH "/archive.bin"
+#define ARCHIVE_OLDPATH "/archive.old" // former archive after rotation
+#define ARCHIVE_MAXBLOCKS 640 // per file, 320 KB
+#define ARCHIVE_FLUSHSECONDS 600 // limit data lost on restarts, and flash wear
+
+class Archive
+{
+  public:
+
+    Archive() {
+      mBlockIndex = 0;
+      mLastWrite = 0;
+      mNumRotations = 0;
+    }
+
+    //  call after SPIFFS has been mounted
+    void begin() {
+      File file = SPIFFS.open(ARCHIVE_PATH, FILE_READ);
+
+      if (file) {
+        int numBlocks = file.size()/ARCHIVE_BLOCKSIZE;
+
+        mBlockIndex = numBlocks;
+
+        if (numBlocks>0) {
+          //  continue with the last block in case it is not full
+          file.seek((numBlocks-1)*ARCHIVE_BLOCKSIZE);
+          if (file.read(mBlock.bytes(), ARCHIVE_BLOCKSIZE)==ARCHIVE_BLOCKSIZE
+              &&mBlock.resume()&&!mBlock.full())
+            mBlockIndex = numBlocks-1;
+          else
+            mBlock.reset();
+        }
+
+        file.close();
+      }
+
+      //  full, e.g. after a restart before the rotation in nextBlock()
+      if (mBlockIndex>=ARCHIVE_MAXBLOCKS)
+        rotate();
+
+      LOG->printf("archive %s opened, continuing with block %d holding %d readings\n",
+        ARCHIVE_PATH, mBlockIndex, mBlock.count());
+    }
+
+    void addPacket(WeatherPacket &packet, time_t time) {
+      if (time<(time_t) 50*365*24*60*60) {
+        //  before 2020, time not configured yet
+        if (DEBUG)
+          LOG->println("archive skips packet, time not configured");
+        return;
+      }
+
+      ArchiveRecord record;
+
+      record.time = time;
+      record.values[TemperatureChannel] = packet.mTemperatureDegreeCelsius;
+      record.values[PressureChannel] = packet.mPressureHPA;
+      record.values[HumidityChannel] = packet.mHumidityPercent;
+      record.values[WindSpeedChannel] = packet.mWindSpeedMpS;
+      record.values[WindDirectionChannel] = packet.windDirectionIndex();
+      record.values[RainChannel] = packet.mDeltaRainMM;
+      record.values[BatteryChannel] = packet.mBatteryVoltage;
+
+      //  never full here, full blocks are written and replaced below
+      mBlock.append(record);
+
+      if (DEBUG)
+        LOG->printf("archive block %d holds %d readings in %d bytes\n",
+          mBlockIndex, mBlock.count(), mBlock.usedBytes());
+
+      if (mBlock.full()) {
+        writeBlock();
+        nextBlock();
+      } else if (time-mLastWrite>=ARCHIVE_FLUSHSECONDS) {
+        writeBlock();
+        mLastWrite = time;
+      }
+    }
+
+    //  the block currently filled, and its position in ARCHIVE_PATH; the copy on flash
+    //  may be outdated
+    const ArchiveBlock &currentBlock() {
+      return mBlock;
+    }
+
+    int currentBlockIndex() {
+      return mBlockIndex;
+    }
+
+    //  cursors reading across loop() passes notice rotations by this
+    unsigned long numRotations() {
+      return mNumRotations;
+    }
+
+  private:
+
+    ArchiveBlock mBlock;
+    int mBlockIndex; // position of mBlock in ARCHIVE_PATH
+    time_t mLastWrite;
+    unsigned long mNumRotations;
+
+    void writeBlock() {
+      File file = SPIFFS.open(ARCHIVE_PATH, SPIFFS.exists(ARCHIVE_PATH)?"r+":FILE_WRITE);
+
+      if (file) {
+        bool succeeded = file.seek(mBlockIndex*ARCHIVE_BLOCKSIZE)
+          &&file.write(mBlock.bytes(), ARCHIVE_BLOCKSIZE)==ARCHIVE_BLOCKSIZE;
+
+        file.close();
+
+        if (!succeeded)
+          LOG->printf("archive failed to write block %d\n", mBlockIndex);
+      } else
+        LOG->printf("archive failed to open %s for writing\n", ARCHIVE_PATH);
+    }
+
+    void nextBlock() {
+      mBlock.reset();
+      mBlockIndex++;
+
+      if (mBlockIndex>=ARCHIVE_MAXBLOCKS)
+        rotate();
+    }
+
+    //  keep the former file only
+    void rotate() {
+      SPIFFS.remove(ARCHIVE_OLDPATH);
+      SPIFFS.rename(ARCHIVE_PATH, ARCHIVE_OLDPATH);
+      mBlockIndex = 0;
+      mNumRotations++;
+
+      LOG->printf("archive rotated %s to %s\n", ARCHIVE_PATH, ARCHIVE_OLDPATH);
+    }
+};
+
+//  sequential access to all readings archived within [from, to], oldest first;
+//  the first block is found by a binary search over the block headers of each
+//  file, so seeking costs O(log n) header reads and memory is constant
+class ArchiveCursor
+{
+  public:
+
+    ArchiveCursor(Archive &archive, uint32_t from, uint32_t to) : mArchive(archive), mReader(mBlock) {
+      mFrom = from;
+      mTo = to;
+      mFileIndex = -1;
+      mBlockIndex = mNumBlocks = 0;
+      mNumRotations = 0;
+      mDone = false;
+    }
+
+    ~ArchiveCursor() {
+      if (mFile)
+        mFile.close();
+    }
+
+    bool next(ArchiveRecord &record) {
+      while (!mDone) {
+        if (mReader.next(record)) {
+          if (record.time<mFrom)
+            continue;
+          if (record.time>mTo)
+            break;
+
+          return true;
+        }
+
+        if (!loadNextBlock())
+          break;
+      }
+
+      mDone = true;
+
+      return false;
+    }
+
+  private:
+
+    Archive &mArchive;
+    uint32_t mFrom, mTo;
+
+    int mFileIndex; // 0 for ARCHIVE_OLDPATH, 1 for ARCHIVE_PATH
+    File mFile;
+    int mBlockIndex, mNumBlocks;
+    unsigned long mNumRotations; // of the archive when ARCHIVE_PATH was opened
+
+    ArchiveBlock mBlock;
+    ArchiveBlockReader mReader;
+    bool mDone;
+
+    bool currentFile() {
+      return mFileIndex==1;
+    }
+
+    bool openNextFile() {
+      if (mFile)
+        mFile.close();
+
+      if (++mFileIndex>1)
+        return false;
+
+      const char *path = currentFile()?ARCHIVE_PATH:ARCHIVE_OLDPATH;
+
+      mFile = SPIFFS.exists(path)?SPIFFS.open(path, FILE_READ):File();
+      mNumBlocks = mFile?mFile.size()/ARCHIVE_BLOCKSIZE:0;
+      mNumRotations = mArchive.numRotations();
+
+      //  the current block may not have been written yet
+      if (currentFile()&&mNumBlocks<=mArchive.currentBlockIndex())
+        mNumBlocks = mArchive.currentBlockIndex()+1;
+
+      mBlockIndex = firstBlock();
+
+      return true;
+    }
+
+    //  after a rotation, the block in memory belongs to another file than the one read
+    bool readBlock(int index, uint8_t *bytes, int numBytes) {
+      if (currentFile()&&mNumRotations==mArchive.numRotations()&&index==mArchive.currentBlockIndex()) {
+        memcpy(bytes, mArchive.currentBlock().bytes(), numBytes);
+        return true;
+      }
+
+      return mFile&&mFile.seek(index*ARCHIVE_BLOCKSIZE)&&mFile.read(bytes, numBytes)==(size_t) numBytes;
+    }
+
+    //  true in case the block is known to start no later than mFrom
+    bool startsBeforeFrom(int index) {
+      ArchiveBlock header;
+
+      return readBlock(index, header.bytes(), ARCHIVE_HEADERSIZE)
+        &&header.valid()&&header.count()>0&&header.firstTime()<=mFrom;
+    }
+
+    //  last block starting no later than mFrom by binary search, blocks of a file are
+    //  in time order; a block with an invalid header counts as starting after mFrom, so
+    //  the search settles on an earlier block and loadNextBlock() skips the invalid ones
+    int firstBlock() {
+      int low = 0, high = mNumBlocks-1;
+
+      if (high<0||!startsBeforeFrom(0))
+        return 0;
+
+      while (low<high) {
+        int middle = (low+high+1)/2;
+
+        if (startsBeforeFrom(middle))
+          low = middle;
+        else
+          high = middle-1;
+      }
+
+      return low;
+    }
+
+    bool loadNextBlock() {
+      for (;;) {
+        if (mBlockIndex>=mNumBlocks) {
+          if (!openNextFile())
+            return false;
+          continue;
+        }
+
+        int index = mBlockIndex++;
+
+        if (!readBlock(index, mBlock.bytes(), ARCHIVE_BLOCKSIZE)||!mBlock.valid()||mBlock.count()==0)
+          continue;
+
+        if (mBlock.firstTime()>mTo)
+          return false;
+
+        mReader = ArchiveBlockReader(mBlock);
+
+        return true;
+      }
+    }
+};
+
+//  values of one channel within [from, to], undefined values skipped
+class ArchiveSeries
+{
+  public:
+
+    ArchiveSeries(Archive &archive, int channel, uint32_t from, uint32_t to) : mCursor(archive, from, to) {
+      mChannel = channel;
+    }
+
+    bool next(uint32_t &time, float &value) {
+      ArchiveRecord record;
+
+      while (mCursor.next(record))
+        if (record.values[mChannel]!=UNDEFINEDVALUE) {
+          time = record.time;
+          value = record.values[mChannel];
+          return true;
+        }
+
+      return false;
+    }
+
+  private:
+
+    ArchiveCursor mCursor;
+    int mChannel;
+};
@@ -0,0 +1,404 @@
+/* --------------------------------------------------------------------------------
+ *  ArchiveBlock
+ *  fixed size block of compressed weather readings, Gorilla style encoding: timestamps
+ *  use delta-of-delta, channel values are XORed against their predecessor
+ *  plain C++ on purpose, the code is shared with the host tools in tools/
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+#ifndef _ARCHIVEBLOCK_H_
+#define _ARCHIVEBLOCK_H_
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define ARCHIVE_BLOCKSIZE 512 // bytes, matches two SPIFFS pages
+#define ARCHIVE_HEADERSIZE 8 // magic, count, first timestamp
+#define ARCHIVE_MAGIC 0xA7C1 // doubles as format version
+
+//  channels stored per reading, keep order - it is part of the format
+enum ArchiveChannel {
+  TemperatureChannel,
+  PressureChannel,
+  HumidityChannel,
+  WindSpeedChannel,
+  WindDirectionChannel, // index 0..15 for N..NNW, -1 if undefined
+  RainChannel, // delta rain of the report
+  BatteryChannel,
+  NumArchiveChannels
+};
+
+static const char *archiveChannelNames[NumArchiveChannels] = {
+  "temperature", "pressure", "humidity", "wind", "winddirection", "rain", "battery"
+};
+
+//  channel for a name in archiveChannelNames, -1 if unknown
+static inline int archiveChannelIndex(const char *name) {
+  for (int c = 0; c<NumArchiveChannels; c++)
+    if (strcmp(name, archiveChannelNames[c])==0)
+      return c;
+
+  return -1;
+}
+
+//  values are rounded to binary fractions below sensor resolution before compression,
+//  this clears the low mantissa bits and multiplies the compression ratio; 0 keeps a
+//  channel lossless
+static const float archiveChannelScale[NumArchiveChannels] = {
+  128.0f, // temperature, 1/128 degree Celsius
+  64.0f, // pressure, 1/64 hPa
+  64.0f, // humidity, 1/64 %
+  64.0f, // wind speed, 1/64 m/s
+  0.0f, // wind direction
+  0.0f, // rain, multiples of one bucket
+  1024.0f // battery, 1/1024 V
+};
+
+//  decimals when formatting values of a channel
+static const int archiveChannelPrecision[NumArchiveChannels] = {
+  1, // temperature
+  1, // pressure
+  1, // humidity
+  1, // wind speed
+  0, // wind direction
+  2, // rain
+  2 // battery
+};
+
+//  worst case bits per reading: 4+32 bits timestamp, 2+5+6+32 bits per channel
+#define ARCHIVE_MAXRECORDBITS (36+NumArchiveChannels*45)
+
+struct ArchiveRecord {
+  uint32_t time; // seconds since epoch
+  float values[NumArchiveChannels];
+};
+
+class ArchiveBlock
+{
+  public:
+
+    ArchiveBlock() {
+      reset();
+    }
+
+    //  start an empty block
+    void reset() {
+      memset(mBytes, 0, ARCHIVE_BLOCKSIZE);
+      writeHeader(ARCHIVE_MAGIC, 0, 0);
+      mBitPos = ARCHIVE_HEADERSIZE*8;
+    }
+
+    uint16_t count() const {
+      return read16(2);
+    }
+
+    uint32_t firstTime() const {
+      return read32(4);
+    }
+
+    bool valid() const {
+      return read16(0)==ARCHIVE_MAGIC;
+    }
+
+    //  true in case the worst case reading does not fit anymore
+    bool full() const {
+      return mBitPos+ARCHIVE_MAXRECORDBITS>ARCHIVE_BLOCKSIZE*8;
+    }
+
+    //  number of bytes used, the remainder is zero
+    int usedBytes() const {
+      return (mBitPos+7)/8;
+    }
+
+    uint8_t *bytes() {
+      return mBytes;
+    }
+
+    const uint8_t *bytes() const {
+      return mBytes;
+    }
+
+    //  append a reading, returns false in case the block is full; values are
+    //  quantized, see archiveChannelScale
+    bool append(const ArchiveRecord &record) {
+      if (full())
+        return false;
+
+      uint16_t numRecords = count();
+
+      if (numRecords==0) {
+        writeHeader(ARCHIVE_MAGIC, 1, record.time);
+        for (int c = 0; c<NumArchiveChannels; c++) {
+          uint32_t bits = floatBits(quantize(c, record.values[c]));
+          writeBits(bits, 32);
+          mPrevBits[c] = bits;
+          mPrevLeading[c] = 0xff; // no window yet
+          mPrevTrailing[c] = 0;
+        }
+        mPrevTime = record.time;
+        mPrevDelta = 0;
+      } else {
+        int32_t delta = (int32_t) (record.time-mPrevTime);
+        int32_t deltaOfDelta = delta-mPrevDelta;
+
+        if (deltaOfDelta==0)
+          writeBits(0b0, 1);
+        else if (deltaOfDelta>=-63&&deltaOfDelta<=64) {
+          writeBits(0b10, 2);
+          writeBits(deltaOfDelta+63, 7);
+        } else if (deltaOfDelta>=-255&&deltaOfDelta<=256) {
+          writeBits(0b110, 3);
+          writeBits(deltaOfDelta+255, 9);
+        } else if (deltaOfDelta>=-2047&&deltaOfDelta<=2048) {
+          writeBits(0b1110, 4);
+          writeBits(deltaOfDelta+2047, 12);
+        } else {
+          writeBits(0b1111, 4);
+          writeBits((uint32_t) deltaOfDelta, 32);
+        }
+        mPrevTime = record.time;
+        mPrevDelta = delta;
+
+        for (int c = 0; c<NumArchiveChannels; c++)
+          appendValue(c, floatBits(quantize(c, record.values[c])));
+
+        writeHeader(ARCHIVE_MAGIC, numRecords+1, firstTime());
+      }
+
+      return true;
+    }
+
+    //  restore the encoder state from bytes loaded into bytes(), required to continue
+    //  appending to a block read back from flash; returns false for invalid blocks
+    bool resume() {
+      if (!valid())
+        return false;
+
+      ArchiveBlockReader reader(*this);
+      ArchiveRecord record;
+      uint16_t numRecords = 0;
+
+      while (reader.next(record))
+        numRecords++;
+
+      if (numRecords!=count())
+        return false;
+
+      mBitPos = reader.mBitPos;
+      mPrevTime = reader.mPrevTime;
+      mPrevDelta = reader.mPrevDelta;
+      for (int c = 0; c<NumArchiveChannels; c++) {
+        mPrevBits[c] = reader.mPrevBits[c];
+        mPrevLeading[c] = reader.mPrevLeading[c];
+        mPrevTrailing[c] = reader.mPrevTrailing[c];
+      }
+
+      return true;
+    }
+
+    static float quantize(int channel, float value) {
+      float scale = archiveChannelScale[channel];
+
+      return scale>0.0f?roundf(value*scale)/scale:value;
+    }
+
+    static uint32_t floatBits(float value) {
+      uint32_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      return bits;
+    }
+
+    static float bitsFloat(uint32_t bits) {
+      float value;
+      memcpy(&value, &bits, sizeof(value));
+      return value;
+    }
+
+    //  sequential decoder for a block
+    class ArchiveBlockReader
+    {
+      public:
+
+        ArchiveBlockReader(const ArchiveBlock &block) {
+          mBytes = block.bytes();
+          mCount = block.valid()?block.count():0;
+          mIndex = 0;
+          mBitPos = ARCHIVE_HEADERSIZE*8;
+          mCorrupted = false;
+        }
+
+        bool next(ArchiveRecord &record) {
+          if (mIndex>=mCount||mCorrupted)
+            return false;
+
+          if (mIndex==0) {
+            mPrevTime = read32At(4);
+            mPrevDelta = 0;
+            for (int c = 0; c<NumArchiveChannels; c++) {
+              mPrevBits[c] = readBits(32);
+              mPrevLeading[c] = 0xff;
+              mPrevTrailing[c] = 0;
+            }
+          } else {
+            int32_t deltaOfDelta;
+
+            if (readBits(1)==0)
+              deltaOfDelta = 0;
+            else if (readBits(1)==0)
+              deltaOfDelta = (int32_t) readBits(7)-63;
+            else if (readBits(1)==0)
+              deltaOfDelta = (int32_t) readBits(9)-255;
+            else if (readBits(1)==0)
+              deltaOfDelta = (int32_t) readBits(12)-2047;
+            else
+              deltaOfDelta = (int32_t) readBits(32);
+
+            mPrevDelta += deltaOfDelta;
+            mPrevTime += mPrevDelta;
+
+            for (int c = 0; c<NumArchiveChannels; c++) {
+              if (readBits(1)) {
+                if (readBits(1)==0&&mPrevLeading[c]!=0xff) {
+                  //  reuse the window of the predecessor
+                  int length = 32-mPrevLeading[c]-mPrevTrailing[c];
+                  mPrevBits[c] ^= readBits(length)<<mPrevTrailing[c];
+                } else {
+                  int leading = readBits(5);
+                  int length = readBits(6);
+                  if (length==0||leading+length>32) {
+                    mCorrupted = true;
+                    return false;
+                  }
+                  int trailing = 32-leading-length;
+                  mPrevBits[c] ^= readBits(length)<<trailing;
+                  mPrevLeading[c] = leading;
+                  mPrevTrailing[c] = trailing;
+                }
+              }
+            }
+          }
+
+          if (mCorrupted)
+            return false;
+
+          record.time = mPrevTime;
+          for (int c = 0; c<NumArchiveChannels; c++)
+            record.values[c] = bitsFloat(mPrevBits[c]);
+
+          mIndex++;
+
+          return true;
+        }
+
+      private:
+
+        friend class ArchiveBlock;
+
+        const uint8_t *mBytes;
+        uint16_t mCount;
+        uint16_t mIndex;
+        int mBitPos;
+        bool mCorrupted;
+
+        uint32_t mPrevTime;
+        int32_t mPrevDelta;
+        uint32_t mPrevBits[NumArchiveChannels];
+        uint8_t mPrevLeading[NumArchiveChannels];
+        uint8_t mPrevTrailing[NumArchiveChannels];
+
+        uint32_t read32At(int offset) {
+          return mBytes[offset]|mBytes[offset+1]<<8|mBytes[offset+2]<<16|(uint32_t) mBytes[offset+3]<<24;
+        }
+
+        uint32_t readBits(int numBits) {
+          uint32_t value = 0;
+
+          //  guard corrupted blocks, never read beyond the block
+          if (mBitPos+numBits>ARCHIVE_BLOCKSIZE*8) {
+            mCorrupted = true;
+            return 0;
+          }
+
+          while (numBits--) {
+            value = value<<1|((mBytes[mBitPos>>3]>>(7-(mBitPos&7)))&1);
+            mBitPos++;
+          }
+
+          return value;
+        }
+    };
+
+  private:
+
+    uint8_t mBytes[ARCHIVE_BLOCKSIZE];
+    int mBitPos;
+
+    //  encoder state
+    uint32_t mPrevTime;
+    int32_t mPrevDelta;
+    uint32_t mPrevBits[NumArchiveChannels];
+    uint8_t mPrevLeading[NumArchiveChannels];
+    uint8_t mPrevTrailing[NumArchiveChannels];
+
+    void appendValue(int c, uint32_t bits) {
+      uint32_t xorBits = bits^mPrevBits[c];
+
+      if (xorBits==0)
+        writeBits(0b0, 1);
+      else {
+        int leading = __builtin_clz(xorBits);
+        int trailing = __builtin_ctz(xorBits);
+
+        if (leading>31)
+          leading = 31;
+
+        if (mPrevLeading[c]!=0xff&&leading>=mPrevLeading[c]&&trailing>=mPrevTrailing[c]) {
+          //  meaningful bits fit into the window of the predecessor
+          writeBits(0b10, 2);
+          writeBits(xorBits>>mPrevTrailing[c], 32-mPrevLeading[c]-mPrevTrailing[c]);
+        } else {
+          int length = 32-leading-trailing;
+          writeBits(0b11, 2);
+          writeBits(leading, 5);
+          writeBits(length, 6);
+          writeBits(xorBits>>trailing, length);
+          mPrevLeading[c] = leading;
+          mPrevTrailing[c] = trailing;
+        }
+      }
+
+      mPrevBits[c] = bits;
+    }
+
+    void writeBits(uint32_t value, int numBits) {
+      while (numBits--) {
+        if ((value>>numBits)&1)
+          mBytes[mBitPos>>3] |= 0x80>>(mBitPos&7);
+        mBitPos++;
+      }
+    }
+
+    void writeHeader(uint16_t magic, uint16_t numRecords, uint32_t time) {
+      mBytes[0] = magic&0xff;
+      mBytes[1] = magic>>8;
+      mBytes[2] = numRecords&0xff;
+      mBytes[3] = numRecords>>8;
+      mBytes[4] = time&0xff;
+      mBytes[5] = (time>>8)&0xff;
+      mBytes[6] = (time>>16)&0xff;
+      mBytes[7] = time>>24;
+    }
+
+    uint16_t read16(int offset) const {
+      return mBytes[offset]|mBytes[offset+1]<<8;
+    }
+
+    uint32_t read32(int offset) const {
+      return mBytes[offset]|mBytes[offset+1]<<8|mBytes[offset+2]<<16|(uint32_t) mBytes[offset+3]<<24;
+    }
+};
+
+typedef ArchiveBlock::ArchiveBlockReader ArchiveBlockReader;
+
+#endif // _ARCHIVEBLOCK_H_
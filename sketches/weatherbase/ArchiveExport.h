@@ -0,0 +1,88 @@
+/* --------------------------------------------------------------------------------
+ *  ArchiveExport
+ *  readings archived within [from, to] as CSV or NDJSON, formatted record by record
+ *  while the server's transfer slot sends them, so an export of months neither blocks
+ *  loop() nor other clients
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+class ArchiveExport : public BolbroPrintSource
+{
+  public:
+
+    ArchiveExport(Archive &archive, uint32_t from, uint32_t to, bool csv) : mCursor(archive, from, to) {
+      mCSV = csv;
+      mHeaderPrinted = !csv;
+      mNumRecords = 0;
+    }
+
+    ~ArchiveExport() {
+      LOG->printf("archive export ended, %ld records\n", mNumRecords);
+    }
+
+  protected:
+
+    //  a line each, the CSV header first
+    bool printPiece(Print *out) {
+      ArchiveRecord record;
+
+      if (!mHeaderPrinted) {
+        out->print("time,epoch");
+        for (int c = 0; c<NumArchiveChannels; c++)
+          out->printf(",%s", archiveChannelNames[c]);
+        out->print("\r\n");
+        mHeaderPrinted = true;
+        return true;
+      }
+
+      if (!mCursor.next(record))
+        return false;
+
+      time_t recordTime = record.time;
+      struct tm t;
+      char isoTime[24];
+
+      gmtime_r(&recordTime, &t);
+      strftime(isoTime, sizeof(isoTime), "%Y-%m-%dT%H:%M:%SZ", &t);
+
+      if (mCSV)
+        out->printf("%s,%u", isoTime, (unsigned) record.time);
+      else
+        out->printf("{\"time\":\"%s\",\"epoch\":%u", isoTime, (unsigned) record.time);
+
+      for (int c = 0; c<NumArchiveChannels; c++) {
+        float value = record.values[c];
+        bool defined = value!=UNDEFINEDVALUE;
+
+        if (mCSV) {
+          //  empty fields for undefined values
+          out->print(",");
+          if (!defined)
+            continue;
+        } else {
+          out->printf(",\"%s\":", archiveChannelNames[c]);
+          if (!defined) {
+            out->print("null");
+            continue;
+          }
+        }
+
+        if (c==WindDirectionChannel)
+          out->printf(mCSV?"%s":"\"%s\"", WeatherPacket::windDirectionName((int) value));
+        else
+          out->printf("%.*f", archiveChannelPrecision[c], value);
+      }
+
+      out->print(mCSV?"\r\n":"}\n");
+      mNumRecords++;
+
+      return true;
+    }
+
+  private:
+
+    ArchiveCursor mCursor;
+    bool mCSV;
+    bool mHeaderPrinted;
+    long mNumRecords;
+};
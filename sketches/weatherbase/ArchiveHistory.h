@@ -0,0 +1,57 @@
+/* --------------------------------------------------------------------------------
+ *  ArchiveHistory
+ *  archived values of a channel downsampled by LTTB as /history.json, points are
+ *  selected and formatted while the server's transfer slot sends them, so long
+ *  ranges neither block loop() nor other clients
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+class ArchiveHistory : public BolbroPrintSource
+{
+  public:
+
+    ArchiveHistory(Archive &archive, int channel, uint32_t from, uint32_t to, long points)
+      : mScan(archive, channel, from, to), mLookahead(archive, channel, from, to),
+        mLttb(mScan, mLookahead, to, points) {
+      mChannel = channel;
+      mFrom = from;
+      mTo = to;
+      mNumSent = -1; // header not printed yet
+    }
+
+    ~ArchiveHistory() {
+      LOG->printf("history %s ended, %ld points\n", archiveChannelNames[mChannel], mNumSent>0?mNumSent:0);
+    }
+
+  protected:
+
+    //  the header, then a point each, then the footer
+    bool printPiece(Print *out) {
+      uint32_t time;
+      float value;
+
+      if (mNumSent<0) {
+        out->printf("{\n\t\"channel\" : \"%s\",\n\t\"from\" : %lu,\n\t\"to\" : %lu,\n\t\"points\" : [",
+          archiveChannelNames[mChannel], (unsigned long) mFrom, (unsigned long) mTo);
+        mNumSent = 0;
+        return true;
+      }
+
+      if (!mLttb.next(time, value)) {
+        out->print("]\n}\n");
+        return false;
+      }
+
+      out->printf("%s[%u,%.*f]", mNumSent++?",":"", (unsigned) time, archiveChannelPrecision[mChannel], value);
+
+      return true;
+    }
+
+  private:
+
+    ArchiveSeries mScan, mLookahead;
+    Lttb<ArchiveSeries> mLttb;
+    int mChannel;
+    uint32_t mFrom, mTo;
+    long mNumSent;
+};
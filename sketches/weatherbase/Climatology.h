@@ -0,0 +1,210 @@
+/* --------------------------------------------------------------------------------
+ *  Climatology
+ *  one record per calendar day in a fixed file of 366 slots on SPIFFS, holding
+ *  the latest year's values and sums over all years recorded; written once per
+ *  day, any date is read by a single seek and read
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+#include <SPIFFS.h>
+
+//  requires DailyMinMax.h and Sun.h
+
+#define CLIMATOLOGY_PATH "/climate.bin"
+#define CLIMATOLOGY_NUMSLOTS 366
+#define CLIMATOLOGY_MAGIC 0xC1
+
+//  values of a day, UNDEFINEDVALUE if not available
+struct ClimateValues {
+  float minTemperature, maxTemperature, meanTemperature; // degree Celsius
+  float rain; // mm
+  float maxGust; // m/s
+  float meanPressure; // hPa
+  float sunHours; // astronomical, sunrise to sunset
+};
+
+#define CLIMATOLOGY_NUMVALUES (sizeof(ClimateValues)/sizeof(float))
+
+class Climatology
+{
+  public:
+
+    //  slot of a day, days of a leap year, 29 February is slot 59
+    static int slot(int month, int dayOfMonth) {
+      static const int16_t firstDays[12] = { 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335 };
+
+      if (month<0||month>11||dayOfMonth<1||dayOfMonth>31)
+        return -1;
+
+      return firstDays[month]+dayOfMonth-1;
+    }
+
+    struct Day {
+      int latestYear;
+      ClimateValues latest;
+      int numYears;
+      ClimateValues mean; // over numYears, UNDEFINEDVALUE for values never recorded
+    };
+
+    Climatology() {
+      mLastDayStored = 0;
+    }
+
+    //  store yesterday once all DailyMinMax instances rolled over; call regularly
+    void update(DailyMinMax &temperature, DailyMinMax &rain, DailyMinMax &wind, DailyMinMax &pressure) {
+      time_t yesterday = temperature.yesterdayStartSeconds();
+
+      if (!yesterday||yesterday==mLastDayStored)
+        return;
+
+      mLastDayStored = yesterday;
+
+      if (!temperature.hasSamples(DailyMinMax::Yesterday))
+        return;
+
+      ClimateValues values;
+
+      values.minTemperature = temperature.min(DailyMinMax::Yesterday);
+      values.maxTemperature = temperature.max(DailyMinMax::Yesterday);
+      values.meanTemperature = temperature.avg(DailyMinMax::Yesterday);
+      values.rain = rain.hasSamples(DailyMinMax::Yesterday)?rain.sum(DailyMinMax::Yesterday):UNDEFINEDVALUE;
+      values.maxGust = wind.hasSamples(DailyMinMax::Yesterday)?wind.max(DailyMinMax::Yesterday):UNDEFINEDVALUE;
+      values.meanPressure = pressure.hasSamples(DailyMinMax::Yesterday)?pressure.avg(DailyMinMax::Yesterday):UNDEFINEDVALUE;
+      values.sunHours = calcDayLength(yesterday+12*60*60);
+
+      struct tm day;
+
+      localtime_r(&yesterday, &day);
+      addDay(day.tm_year+1900, day.tm_mon, day.tm_mday, values);
+    }
+
+    void addDay(int year, int month, int dayOfMonth, const ClimateValues &values) {
+      int index = slot(month, dayOfMonth);
+      Record record;
+
+      if (index<0)
+        return;
+
+      if (!readRecord(index, record)||record.magic!=CLIMATOLOGY_MAGIC)
+        memset(&record, 0, sizeof(record));
+      else if (record.latestYear==year)
+        //  day stored before, replace it
+        removeFromSums(record);
+
+      record.magic = CLIMATOLOGY_MAGIC;
+      record.latestYear = year;
+      encode(values, record.latest);
+
+      const float *v = (const float *) &values;
+
+      for (unsigned i = 0; i<CLIMATOLOGY_NUMVALUES; i++)
+        if (v[i]!=UNDEFINEDVALUE) {
+          record.sums[i] += v[i];
+          record.counts[i]++;
+        }
+
+      writeRecord(index, record);
+
+      LOG->printf("climatology stored %04d-%02d-%02d in slot %d\n", year, month+1, dayOfMonth, index);
+    }
+
+    //  false if nothing has been recorded for the date
+    bool day(int month, int dayOfMonth, Day &day) {
+      int index = slot(month, dayOfMonth);
+      Record record;
+
+      if (index<0||!readRecord(index, record)||record.magic!=CLIMATOLOGY_MAGIC)
+        return false;
+
+      day.latestYear = record.latestYear;
+      decode(record.latest, day.latest);
+
+      float *mean = (float *) &day.mean;
+
+      day.numYears = 0;
+      for (unsigned i = 0; i<CLIMATOLOGY_NUMVALUES; i++) {
+        mean[i] = record.counts[i]>0?record.sums[i]/record.counts[i]:UNDEFINEDVALUE;
+        if (record.counts[i]>day.numYears)
+          day.numYears = record.counts[i];
+      }
+
+      return true;
+    }
+
+  private:
+
+    time_t mLastDayStored;
+
+    //  60 bytes per slot without padding, values of the latest year scaled to 1/10
+    struct Record {
+      uint8_t magic;
+      uint8_t reserved;
+      uint16_t latestYear;
+      int16_t latest[CLIMATOLOGY_NUMVALUES]; // INT16_MIN if undefined
+      uint16_t counts[CLIMATOLOGY_NUMVALUES]; // years per value
+      float sums[CLIMATOLOGY_NUMVALUES];
+    };
+
+    static void encode(const ClimateValues &values, int16_t *encoded) {
+      const float *v = (const float *) &values;
+
+      for (unsigned i = 0; i<CLIMATOLOGY_NUMVALUES; i++)
+        encoded[i] = v[i]==UNDEFINEDVALUE?INT16_MIN:constrain(lroundf(v[i]*10), INT16_MIN+1, INT16_MAX);
+    }
+
+    static void decode(const int16_t *encoded, ClimateValues &values) {
+      float *v = (float *) &values;
+
+      for (unsigned i = 0; i<CLIMATOLOGY_NUMVALUES; i++)
+        v[i] = encoded[i]==INT16_MIN?UNDEFINEDVALUE:encoded[i]/10.0f;
+    }
+
+    static void removeFromSums(Record &record) {
+      ClimateValues values;
+
+      decode(record.latest, values);
+
+      const float *v = (const float *) &values;
+
+      for (unsigned i = 0; i<CLIMATOLOGY_NUMVALUES; i++)
+        if (v[i]!=UNDEFINEDVALUE&&record.counts[i]>0) {
+          record.sums[i] -= v[i];
+          record.counts[i]--;
+        }
+    }
+
+    bool readRecord(int index, Record &record) {
+      File file = SPIFFS.open(CLIMATOLOGY_PATH, FILE_READ);
+      bool succeeded = file&&file.seek(index*sizeof(Record))
+        &&file.read((uint8_t *) &record, sizeof(Record))==sizeof(Record);
+
+      if (file)
+        file.close();
+
+      return succeeded;
+    }
+
+    void writeRecord(int index, const Record &record) {
+      if (!SPIFFS.exists(CLIMATOLOGY_PATH)) {
+        //  create all slots at once, the file never grows afterwards
+        File file = SPIFFS.open(CLIMATOLOGY_PATH, FILE_WRITE);
+        Record empty;
+
+        memset(&empty, 0, sizeof(empty));
+        for (int i = 0; file&&i<CLIMATOLOGY_NUMSLOTS; i++)
+          file.write((const uint8_t *) &empty, sizeof(empty));
+        if (file)
+          file.close();
+      }
+
+      File file = SPIFFS.open(CLIMATOLOGY_PATH, "r+");
+      bool succeeded = file&&file.seek(index*sizeof(Record))
+        &&file.write((const uint8_t *) &record, sizeof(Record))==sizeof(Record);
+
+      if (file)
+        file.close();
+
+      if (!succeeded)
+        LOG->printf("climatology failed to write slot %d\n", index);
+    }
+};
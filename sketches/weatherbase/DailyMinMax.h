@@ -1,6 +1,8 @@
-/* -------------------------------------------------------------------------------- 
+/* --------------------------------------------------------------------------------
  *  DailyMinMax
- *  memorize in-day, min and max values
+ *  memorize min, max, and sum of values for today, yesterday, this week, this
+ *  month, and this year; the next day boundary is cached, so adding a sample costs
+ *  a compare unless the day changed
  *  Harald Schlangmann, April 2021
  * -------------------------------------------------------------------------------- */
 
@@ -10,80 +12,183 @@ class DailyMinMax
 {
   public:
 
+    enum Period {
+      Today,
+      Yesterday,
+      ThisWeek, // starting Monday
+      ThisMonth,
+      ThisYear,
+      NumPeriods
+    };
+
+    static const char *periodName(Period period) {
+      static const char *names[NumPeriods] = { "today", "yesterday", "week", "month", "year" };
+
+      return names[period];
+    }
+
     DailyMinMax(const char *name) {
       mName = name;
-      mHasSamples = false;
+      mNextDaySeconds = 0;
       mStartOfDaySeconds = 0;
+      mYesterdayStartSeconds = 0;
+      mWeekStartSeconds = 0;
+      mMonth = mYear = -1;
+
+      for (int p = 0; p<NumPeriods; p++)
+        mRecords[p].reset();
     }
 
-    bool hasSamples() {
-      return mHasSamples;
+    bool hasSamples(Period period = Today) {
+      return mRecords[period].count>0;
     }
 
-    void addSample(float value) {
-      //  check if we are on the same day...
-      time_t currentTime = time(NULL);
-      struct tm *dayDateTime = localtime(&currentTime);
-
-      dayDateTime->tm_sec = 0;
-      dayDateTime->tm_min = 0;
-      dayDateTime->tm_hour = 0;
-
-      time_t currentBeginOfDay = mktime(dayDateTime);
-
-      if (!mStartOfDaySeconds||currentBeginOfDay!=mStartOfDaySeconds) {
-        //  new day, reset
-        mHasSamples = false;
-        mStartOfDaySeconds = currentBeginOfDay;
-        if (DEBUG) {
-          LOG->print("reset min max for ");
-          LOG->println(mName);
-        }
+    void addSample(float value, time_t now = time(NULL)) {
+      checkRollover(now);
+
+      //  yesterday is complete, never updated
+      for (int p = 0; p<NumPeriods; p++)
+        if (p!=Yesterday)
+          mRecords[p].add(value);
+
+      if (DEBUG) {
+        LOG->printf("updated min to %.1f, max to %.1f and sum to %.1f for %s\n",
+          mRecords[Today].min, mRecords[Today].max, mRecords[Today].sum, mName);
       }
-      
-      if (mHasSamples) {
-        mLast = value;
-        if (value<mMin)
-          mMin = value;
-        if (value>mMax)
-          mMax = value;
+    }
+
+    //  for channels reported as differences like rain, sum() is the total
+    void addDeltaSample(float deltaValue, time_t now = time(NULL)) {
+      addSample(deltaValue, now);
+    }
+
+    //  start new periods in case a day boundary passed, returns true if so; called by
+    //  addSample(), call regularly to roll over without samples
+    bool checkRollover(time_t now = time(NULL)) {
+      if (now<mNextDaySeconds)
+        return false;
+
+      struct tm today;
+      time_t startOfDay = startOfDaySeconds(now, &today);
+      struct tm monday = today;
+
+      monday.tm_mday -= (today.tm_wday+6)%7;
+      time_t weekStart = mktime(&monday);
+
+      //  yesterday only in case the previous day was seen
+      if (mStartOfDaySeconds&&previousDaySeconds(startOfDay)==mStartOfDaySeconds) {
+        mRecords[Yesterday] = mRecords[Today];
+        mYesterdayStartSeconds = mStartOfDaySeconds;
       } else {
-        mMin = mMax = mLast = value;
-        mHasSamples = true;
+        mRecords[Yesterday].reset();
+        mYesterdayStartSeconds = 0;
       }
 
+      mRecords[Today].reset();
+
+      if (weekStart!=mWeekStartSeconds)
+        mRecords[ThisWeek].reset();
+      if (today.tm_mon!=mMonth||today.tm_year!=mYear)
+        mRecords[ThisMonth].reset();
+      if (today.tm_year!=mYear)
+        mRecords[ThisYear].reset();
+
+      mStartOfDaySeconds = startOfDay;
+      mNextDaySeconds = nextDaySeconds(today);
+      mWeekStartSeconds = weekStart;
+      mMonth = today.tm_mon;
+      mYear = today.tm_year;
+
       if (DEBUG) {
-        LOG->printf("updated min to %.1f, max to %.1f and last to %.1f for %s\n",
-          mMin, mMax, mLast, mName);
+        LOG->print("reset min max for ");
+        LOG->println(mName);
       }
+
+      return true;
+    }
+
+    //  local midnight starting yesterday, 0 if yesterday has not been seen
+    time_t yesterdayStartSeconds() {
+      return mYesterdayStartSeconds;
     }
 
-    void addDeltaSample(float deltaValue) {
-      if (hasSamples())
-        addSample(mLast+deltaValue);
-      else
-        addSample(deltaValue);
+    //  call with hasSamples() true only
+    float max(Period period = Today) {
+      return mRecords[period].max;
     }
 
     //  call with hasSamples() true only
-    float max() {
-      return mMax;      
+    float min(Period period = Today) {
+      return mRecords[period].min;
     }
 
     //  call with hasSamples() true only
-    float min() {
-      return mMin;      
+    float range(Period period = Today) {
+      return max(period)-min(period);
+    }
+
+    float sum(Period period = Today) {
+      return mRecords[period].sum;
     }
 
     //  call with hasSamples() true only
-    float range() {
-      return max()-min();
+    float avg(Period period = Today) {
+      return mRecords[period].sum/mRecords[period].count;
+    }
+
+    //  local midnight starting the day of time, tm set to that midnight
+    static time_t startOfDaySeconds(time_t time, struct tm *tm) {
+      localtime_r(&time, tm);
+
+      tm->tm_sec = 0;
+      tm->tm_min = 0;
+      tm->tm_hour = 0;
+      tm->tm_isdst = -1;
+
+      return mktime(tm);
+    }
+
+    //  local midnight following the day of tm (a day may last 23 or 25 hours)
+    static time_t nextDaySeconds(struct tm day) {
+      day.tm_mday++;
+      day.tm_isdst = -1;
+
+      return mktime(&day);
     }
 
   private:
 
+    struct Record {
+      float min, max, sum;
+      long count;
+
+      void reset() {
+        min = max = sum = 0;
+        count = 0;
+      }
+
+      void add(float value) {
+        if (count==0||value<min)
+          min = value;
+        if (count==0||value>max)
+          max = value;
+        sum += value;
+        count++;
+      }
+    };
+
     const char *mName;
-    float mMin, mMax, mLast;
-    bool mHasSamples;
+    Record mRecords[NumPeriods];
+
+    time_t mNextDaySeconds; // the common path compares with this only
     time_t mStartOfDaySeconds;
+    time_t mYesterdayStartSeconds;
+    time_t mWeekStartSeconds;
+    int mMonth, mYear;
+
+    static time_t previousDaySeconds(time_t startOfDay) {
+      struct tm day;
+
+      return startOfDaySeconds(startOfDay-12*60*60, &day);
+    }
 };
@@ -0,0 +1,144 @@
+/* --------------------------------------------------------------------------------
+ *  DerivedMetrics
+ *  values derived from the current packet and wind history, computed once per
+ *  packet accepted so web requests only format precomputed values
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+#include "WeatherConfig.h"
+
+//  requires History.h and Zambretti.h
+
+#define MPS2KNOTS 1.94384f
+
+class DerivedMetrics
+{
+  public:
+
+    //  UNDEFINEDVALUE if not available or not applicable
+    float mDewPointDegreeCelsius;
+    float mHeatIndexDegreeCelsius; // 27 degree Celsius and above only
+    float mWindChillDegreeCelsius; // 10 degree Celsius and below, wind above 4.8 km/h only
+    float mSeaLevelPressureHPA;
+
+    float mWindMpS, mWindKnots; // average over the wind history
+    int mWindBeaufort;
+    float mGustsMpS, mGustsKnots; // maximum of the wind history
+    int mGustsBeaufort;
+
+    float mBatteryPercentage;
+
+    //  formatted time of the packet, empty if not received yet
+    char mUpdated[32]; // e.g. "Sat Oct 18 14:03:22 2026"
+    char mUpdatedDE[40]; // e.g. "18. Oktober 14:03:22", HTML encoded
+
+    DerivedMetrics() {
+      WeatherPacket packet;
+
+      update(packet, NULL, 0);
+    }
+
+    void update(WeatherPacket &packet, History *windHistory, time_t updated) {
+      float temperature = packet.mTemperatureDegreeCelsius;
+      float humidity = packet.mHumidityPercent;
+
+      mDewPointDegreeCelsius = mHeatIndexDegreeCelsius = mWindChillDegreeCelsius = UNDEFINEDVALUE;
+      mSeaLevelPressureHPA = UNDEFINEDVALUE;
+      mWindMpS = mWindKnots = mGustsMpS = mGustsKnots = UNDEFINEDVALUE;
+      mWindBeaufort = mGustsBeaufort = -1;
+      mBatteryPercentage = UNDEFINEDVALUE;
+
+      if (temperature!=UNDEFINEDVALUE&&humidity!=UNDEFINEDVALUE&&humidity>0) {
+        mDewPointDegreeCelsius = dewPoint(temperature, humidity);
+
+        if (temperature>=27.0f)
+          mHeatIndexDegreeCelsius = heatIndex(temperature, humidity);
+      }
+
+      if (packet.mPressureHPA!=UNDEFINEDVALUE)
+        mSeaLevelPressureHPA = Zambretti::seaLevelPressure(packet.mPressureHPA, temperature);
+
+      if (windHistory&&windHistory->hasSamples()) {
+        mWindMpS = windHistory->avg();
+        mWindKnots = mWindMpS*MPS2KNOTS;
+        mWindBeaufort = beaufort(mWindMpS);
+
+        mGustsMpS = windHistory->max();
+        mGustsKnots = mGustsMpS*MPS2KNOTS;
+        mGustsBeaufort = beaufort(mGustsMpS);
+
+        float windKmpH = mWindMpS*3.6f;
+
+        if (temperature!=UNDEFINEDVALUE&&temperature<=10.0f&&windKmpH>4.8f)
+          mWindChillDegreeCelsius = windChill(temperature, windKmpH);
+      }
+
+      if (packet.mBatteryVoltage!=UNDEFINEDVALUE)
+        mBatteryPercentage = packet.batteryPercentage();
+
+      formatTimes(updated);
+    }
+
+    //  Beaufort number, WMO upper limits in m/s
+    static int beaufort(float speedMpS) {
+      static const float limits[12] = {
+        0.3f, 1.6f, 3.4f, 5.5f, 8.0f, 10.8f, 13.9f, 17.2f, 20.8f, 24.5f, 28.5f, 32.7f
+      };
+      int number = 0;
+
+      while (number<12&&speedMpS>=limits[number])
+        number++;
+
+      return number;
+    }
+
+  private:
+
+    //  Magnus formula
+    static float dewPoint(float temperature, float humidity) {
+      float gamma = logf(humidity/100.0f)+17.62f*temperature/(243.12f+temperature);
+
+      return 243.12f*gamma/(17.62f-gamma);
+    }
+
+    //  NOAA (Rothfusz) regression, computed in degree Fahrenheit
+    static float heatIndex(float temperature, float humidity) {
+      float t = temperature*1.8f+32.0f, r = humidity;
+      float hi = -42.379f+2.04901523f*t+10.14333127f*r-0.22475541f*t*r-0.00683783f*t*t
+        -0.05481717f*r*r+0.00122874f*t*t*r+0.00085282f*t*r*r-0.00000199f*t*t*r*r;
+
+      return (hi-32.0f)/1.8f;
+    }
+
+    //  Environment Canada / JAG/TI formula, wind in km/h
+    static float windChill(float temperature, float windKmpH) {
+      float v = powf(windKmpH, 0.16f);
+
+      return 13.12f+0.6215f*temperature-11.37f*v+0.3965f*temperature*v;
+    }
+
+    void formatTimes(time_t updated) {
+      static const char *days[] = { "Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat" };
+      static const char *months[] = {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+      };
+      static const char *monthsDE[] = {
+        "Januar", "Februar", "M&auml;rz", "April", "Mai", "Juni",
+        "Juli", "August", "September", "Oktober", "November", "Dezember"
+      };
+
+      mUpdated[0] = mUpdatedDE[0] = '\0';
+
+      if (!updated)
+        return;
+
+      struct tm t;
+
+      localtime_r(&updated, &t);
+
+      snprintf(mUpdated, sizeof(mUpdated), "%s %s %d %02d:%02d:%02d %d",
+        days[t.tm_wday], months[t.tm_mon], t.tm_mday, t.tm_hour, t.tm_min, t.tm_sec, t.tm_year+1900);
+      snprintf(mUpdatedDE, sizeof(mUpdatedDE), "%d. %s %02d:%02d:%02d",
+        t.tm_mday, monthsDE[t.tm_mon], t.tm_hour, t.tm_min, t.tm_sec);
+    }
+};
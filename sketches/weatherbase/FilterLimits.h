@@ -0,0 +1,14 @@
+/* --------------------------------------------------------------------------------
+ *  FilterLimits
+ *  plausibility limits of the base's sample filters, shared by weatherbase and
+ *  tools/reaggregate so both filter the same way; customize limits here
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+//  requires SampleFilter.h
+
+static const SampleFilterLimits temperatureLimits = { "temperature", -40.0f, 60.0f, 1.0f, 3.0f };
+static const SampleFilterLimits pressureLimits = { "pressure", 850.0f, 1090.0f, 0.5f, 2.0f };
+static const SampleFilterLimits humidityLimits = { "humidity", 0.0f, 100.0f, 10.0f, 20.0f };
+static const SampleFilterLimits windSpeedLimits = { "windspeed", 0.0f, 70.0f, FILTER_UNLIMITED, 25.0f }; // gusts change fast
+static const SampleFilterLimits rainLimits = { "rain", 0.0f, 50.0f, FILTER_UNLIMITED, FILTER_UNLIMITED }; // per report
@@ -0,0 +1,193 @@
+/* --------------------------------------------------------------------------------
+ *  Forecast
+ *  daily forecast fetched by a task of its own once per interval, trimmed to the
+ *  members index.html shows and kept in RAM, so browsers share one upstream request
+ *  and never see the API key; the last document fetched is kept if upstream fails
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+#include <HTTPClient.h>
+#include <ArduinoJson.h>
+
+#define FORECAST_SIZE 3072 // trimmed document, 16 days take about 2 KB
+#define FORECAST_PARSESIZE 8192 // ArduinoJson memory pool while trimming
+#define FORECAST_URLSIZE 256
+#define FORECAST_INTERVAL (15*60) // seconds between fetches
+#define FORECAST_RETRY 60 // seconds until a failed fetch is retried
+#define FORECAST_TIMEOUT 5000 // ms to connect and per read
+#define FORECAST_STACKSIZE 8192
+#define FORECAST_STATUSSIZE 64
+
+class Forecast
+{
+  public:
+
+    Forecast() {
+      mURL[0] = '\0';
+      mMutex = NULL;
+      mLength = 0;
+      mVersion = 0;
+      mStale = false;
+      mNumFetches = 0;
+      mNumFailures = 0;
+      mStatus[0] = '\0';
+    }
+
+    //  urlFormat gets latitude, longitude, number of days, and API key as for the
+    //  OpenWeather daily forecast; a URL without conversions is taken as is, e.g. that
+    //  of a local mock server
+    void begin(const char *urlFormat, float latitude, float longitude, int numDays, const char *apiKey) {
+      snprintf(mURL, sizeof(mURL), urlFormat, latitude, longitude, numDays, apiKey);
+      mMutex = xSemaphoreCreateMutex();
+      xTaskCreate(task, "forecast", FORECAST_STACKSIZE, this, 1, NULL);
+    }
+
+    //  document and state are accessed between lock() and unlock() only, the task does
+    //  not replace the document meanwhile
+    bool lock() {
+      return mMutex&&xSemaphoreTake(mMutex, portMAX_DELAY)==pdTRUE;
+    }
+
+    void unlock() {
+      xSemaphoreGive(mMutex);
+    }
+
+    const char *json() {
+      return mJson;
+    }
+
+    size_t length() {
+      return mLength;
+    }
+
+    //  0 until the first document was fetched
+    unsigned long version() {
+      return mVersion;
+    }
+
+    //  the latest fetch failed, the document is older than FORECAST_INTERVAL
+    bool stale() {
+      return mStale;
+    }
+
+    unsigned long numFetches() {
+      return mNumFetches;
+    }
+
+    unsigned long numFailures() {
+      return mNumFailures;
+    }
+
+    //  prints the outcome of the latest fetch once, to be called from loop(); the task
+    //  does not print itself as LOG is not thread-safe
+    void report(Print *out) {
+      char status[FORECAST_STATUSSIZE];
+
+      if (!mMutex||xSemaphoreTake(mMutex, 0)!=pdTRUE)
+        return; // the task holds the lock, next loop
+
+      strcpy(status, mStatus);
+      mStatus[0] = '\0';
+      unlock();
+
+      if (*status)
+        out->println(status);
+    }
+
+  private:
+
+    char mURL[FORECAST_URLSIZE];
+    SemaphoreHandle_t mMutex;
+    char mJson[FORECAST_SIZE];
+    size_t mLength;
+    unsigned long mVersion;
+    bool mStale;
+    unsigned long mNumFetches, mNumFailures;
+    char mStatus[FORECAST_STATUSSIZE]; // not yet reported
+
+    static void task(void *parameter) {
+      Forecast *forecast = (Forecast *) parameter;
+
+      for (;;) {
+        bool fetched = forecast->fetch();
+
+        vTaskDelay(pdMS_TO_TICKS((fetched?FORECAST_INTERVAL:FORECAST_RETRY)*1000ul));
+      }
+    }
+
+    //  members of the upstream document used by index.html, the first element of list
+    //  stands for all days
+    static void buildFilter(JsonDocument &filter) {
+      filter["city"]["name"] = true;
+      filter["list"][0]["dt"] = true;
+      filter["list"][0]["temp"]["min"] = true;
+      filter["list"][0]["temp"]["max"] = true;
+      filter["list"][0]["weather"][0]["icon"] = true;
+      filter["list"][0]["speed"] = true;
+      filter["list"][0]["deg"] = true;
+      filter["list"][0]["rain"] = true;
+    }
+
+    //  parsed from the stream, so only the trimmed document is held in memory
+    bool fetch() {
+      char status[FORECAST_STATUSSIZE] = "";
+      bool result = false;
+
+      mNumFetches++;
+
+      if (WiFi.status()==WL_CONNECTED) {
+        HTTPClient http;
+
+        http.begin(mURL);
+        http.setConnectTimeout(FORECAST_TIMEOUT);
+        http.setTimeout(FORECAST_TIMEOUT);
+        http.useHTTP10(true); // no chunked transfer encoding within the stream
+
+        int httpResponseCode = http.GET();
+
+        if (httpResponseCode==HTTP_CODE_OK) {
+          StaticJsonDocument<256> filter;
+          DynamicJsonDocument document(FORECAST_PARSESIZE);
+
+          buildFilter(filter);
+
+          DeserializationError err = deserializeJson(document, http.getStream(),
+            DeserializationOption::Filter(filter));
+
+          if (err!=DeserializationError::Ok)
+            snprintf(status, sizeof(status), "forecast not parsed: %s", err.c_str());
+          else if (document["list"].size()==0)
+            snprintf(status, sizeof(status), "forecast without days");
+          else {
+            document["fetched"] = (long) time(NULL);
+
+            if (measureJson(document)>=FORECAST_SIZE)
+              snprintf(status, sizeof(status), "forecast exceeds %d bytes", FORECAST_SIZE);
+            else if (lock()) {
+              mLength = serializeJson(document, mJson, FORECAST_SIZE);
+              mVersion++;
+              mStale = false;
+              unlock();
+
+              snprintf(status, sizeof(status), "forecast fetched, %u bytes", (unsigned) mLength);
+              result = true;
+            }
+          }
+        } else
+          snprintf(status, sizeof(status), "forecast not fetched: %d", httpResponseCode);
+
+        http.end();
+      }
+
+      if (lock()) {
+        if (!result) {
+          mStale = mVersion>0;
+          mNumFailures++;
+        }
+        strcpy(mStatus, status);
+        unlock();
+      }
+
+      return result;
+    }
+};
@@ -2,11 +2,14 @@
  *  History
  *  store a time series and allow aggregation
  *  memory management not super efficient, do not use for excessive time and samples
+ *  least squares regression sums are maintained on insert and expiry for trend()
  *  Harald Schlangmann, April 2021
  * -------------------------------------------------------------------------------- */
 
 #include "WeatherConfig.h"
 
+#define REGRESSION_REBASEMILLIS (24*60*60*1000ul) // recompute regression sums once a day
+
 class History
 {
   public:
@@ -18,6 +21,9 @@ class History
 
       mAggregatedVoid = true;
       mMax = mMin = mAvg = 0;
+
+      mOriginMillis = 0;
+      resetRegression();
       
       mCapacity = mCount = 0;
     }
@@ -60,7 +66,16 @@ class History
 
       //  add value
       mSamples[mCount].time = millis();
-      mSamples[mCount++].value = value;
+      mSamples[mCount].value = value;
+
+      if (mCount==0)
+        //  restart regression, avoids accumulating rounding errors
+        resetRegression(mSamples[0].time);
+      else if (mSamples[0].time-mOriginMillis>REGRESSION_REBASEMILLIS)
+        //  keep times relative to origin small, recompute sums from scratch
+        rebaseRegression();
+
+      addToRegression(mSamples[mCount++], 1);
 
       if (DEBUG) {
         LOG->print("history ");
@@ -126,6 +141,17 @@ class History
       return max()-min();
     }
 
+    //  least squares slope as change per seconds, e.g. trend(3*60*60) for hPa/3h;
+    //  0 if less than two samples
+    float trend(int seconds) {
+      double denominator = mCount*mSumTT-mSumT*mSumT;
+
+      if (mCount<2||denominator<=0)
+        return 0;
+
+      return (mCount*mSumTV-mSumT*mSumV)/denominator*seconds;
+    }
+
     float change() {
       if (mCount>=2)
         return mSamples[mCount-1].value-mSamples[0].value;
@@ -180,6 +206,30 @@ class History
     int mCapacity;
     int mCount;
 
+    //  regression sums, times in seconds relative to mOriginMillis
+    unsigned long mOriginMillis;
+    double mSumT, mSumV, mSumTT, mSumTV;
+
+    void resetRegression(unsigned long originMillis = 0) {
+      mOriginMillis = originMillis;
+      mSumT = mSumV = mSumTT = mSumTV = 0;
+    }
+
+    void addToRegression(const struct Sample &sample, int sign) {
+      double t = (sample.time-mOriginMillis)/1000.0;
+
+      mSumT += sign*t;
+      mSumV += sign*sample.value;
+      mSumTT += sign*t*t;
+      mSumTV += sign*t*sample.value;
+    }
+
+    void rebaseRegression() {
+      resetRegression(mSamples[0].time);
+      for (int i = 0; i<mCount; i++)
+        addToRegression(mSamples[i], 1);
+    }
+
     //  drop samples older than mSeconds, returns true in case items have been removed
     bool expire() {
       if (mCount) {
@@ -196,6 +246,9 @@ class History
         }
   
         if (numToExpire) {
+          for (int i = 0; i<numToExpire; i++)
+            addToRegression(mSamples[i], -1);
+
           memmove(mSamples, mSamples+numToExpire, sizeof(struct Sample)*(mCount-numToExpire));
           mCount -= numToExpire;
           mAggregatedVoid = true;
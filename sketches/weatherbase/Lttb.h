@@ -0,0 +1,155 @@
+/* --------------------------------------------------------------------------------
+ *  Lttb
+ *  downsample a time series to a given number of points using Largest-Triangle-
+ *  Three-Buckets (Steinarsson, 2013); works on sequential series (see ArchiveSeries)
+ *  with constant memory, one series selects points, a second one runs a bucket
+ *  ahead to provide the average of the following bucket; buckets split the time
+ *  range rather than the number of points, so the series is never counted, and
+ *  points are selected one at a time, so callers can interleave other work
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+//  scan and lookahead are two fresh instances of the same series within [from, to],
+//  next() returns the points selected, at most threshold of them; empty buckets, e.g.
+//  while the station was offline, yield no point
+template <class Series>
+class Lttb
+{
+  public:
+
+    Lttb(Series &scan, Series &lookahead, uint32_t to, long threshold) : mScan(scan), mLookahead(lookahead) {
+      mTo = to;
+      mNumBuckets = threshold>3?threshold-2:1;
+      mBucket = -1;
+      mScanPending = mLookaheadPending = false;
+      mHasLookaheadLast = false;
+    }
+
+    bool next(uint32_t &time, float &value) {
+      if (mBucket<0) {
+        //  first point is always kept, times relative to it to preserve precision
+        if (!mScan.next(mATime, mAValue))
+          return false;
+        mLookahead.next(time, value);
+
+        mBucket = 0;
+        mFirstTime = mATime;
+        mEvery = (double) (mTo-mFirstTime)/mNumBuckets;
+        mLastTime = time = mATime;
+        value = mAValue;
+        return true;
+      }
+
+      while (mBucket<mNumBuckets) {
+        uint32_t end = bucketEnd(mBucket);
+        uint32_t nextEnd = mBucket+1<mNumBuckets?bucketEnd(mBucket+1):end;
+
+        //  average of the next bucket, lookahead is positioned at its start already
+        //  except for the first bucket; its last point read stands in if the next
+        //  bucket is empty, for the last bucket that is the last point of the series
+        double avgTime = 0, avgValue = 0;
+        long avgCount = 0;
+        uint32_t t;
+        float v;
+
+        while (nextLookahead(end, t, v))
+          ;
+        while (nextLookahead(nextEnd, t, v)) {
+          avgTime += (double) (t-mATime);
+          avgValue += v;
+          avgCount++;
+        }
+
+        if (avgCount>0) {
+          avgTime /= avgCount;
+          avgValue /= avgCount;
+        } else if (mHasLookaheadLast) {
+          avgTime = (double) (mLookaheadLastTime-mATime);
+          avgValue = mLookaheadLastValue;
+        }
+
+        //  point of this bucket spanning the largest triangle with a and the average
+        double maxArea = -1;
+        uint32_t maxTime = 0;
+        float maxValue = 0;
+
+        while (nextScan(end, t, v)) {
+          double area = fabs((double) (t-mATime)*(avgValue-mAValue)-avgTime*(v-mAValue));
+
+          if (area>maxArea) {
+            maxArea = area;
+            maxTime = t;
+            maxValue = v;
+          }
+        }
+
+        mBucket++;
+
+        if (maxArea>=0) {
+          mATime = mLastTime = time = maxTime;
+          mAValue = value = maxValue;
+          return true;
+        }
+      }
+
+      //  last point is always kept, unless the last bucket selected it already
+      if (mHasLookaheadLast&&mLookaheadLastTime!=mLastTime) {
+        mLastTime = time = mLookaheadLastTime;
+        value = mLookaheadLastValue;
+        return true;
+      }
+
+      return false;
+    }
+
+  private:
+
+    Series &mScan, &mLookahead;
+    uint32_t mTo;
+    long mNumBuckets, mBucket; // -1 before the first point
+    uint32_t mFirstTime; // buckets are laid out from here
+    double mEvery; // seconds per bucket
+
+    uint32_t mATime, mLastTime; // point selected last
+    float mAValue;
+
+    //  a point read beyond the current bucket is kept for the next one
+    bool mScanPending, mLookaheadPending;
+    uint32_t mScanTime, mLookaheadTime;
+    float mScanValue, mLookaheadValue;
+
+    bool mHasLookaheadLast;
+    uint32_t mLookaheadLastTime;
+    float mLookaheadLastValue;
+
+    uint32_t bucketEnd(long bucket) {
+      return bucket>=mNumBuckets-1?mTo:mFirstTime+(uint32_t) ((bucket+1)*mEvery);
+    }
+
+    bool nextScan(uint32_t end, uint32_t &time, float &value) {
+      if (!mScanPending&&!mScan.next(mScanTime, mScanValue))
+        return false;
+
+      mScanPending = mScanTime>end;
+      if (mScanPending)
+        return false;
+
+      time = mScanTime;
+      value = mScanValue;
+      return true;
+    }
+
+    bool nextLookahead(uint32_t end, uint32_t &time, float &value) {
+      if (!mLookaheadPending&&!mLookahead.next(mLookaheadTime, mLookaheadValue))
+        return false;
+
+      mLookaheadPending = mLookaheadTime>end;
+      if (mLookaheadPending)
+        return false;
+
+      time = mLookaheadLastTime = mLookaheadTime;
+      value = mLookaheadLastValue = mLookaheadValue;
+      mHasLookaheadLast = true;
+      return true;
+    }
+};
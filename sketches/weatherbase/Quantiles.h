@@ -0,0 +1,193 @@
+/* --------------------------------------------------------------------------------
+ *  Quantiles
+ *  streaming quantile estimation using the P² algorithm (Jain and Chlamtac, 1985),
+ *  five markers per quantile, O(1) per sample and no samples stored
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+#include "WeatherConfig.h"
+
+//  estimates a single quantile p of all samples added since reset()
+class Quantile
+{
+  public:
+
+    Quantile(float p) {
+      mP = p;
+      reset();
+    }
+
+    void reset() {
+      mCount = 0;
+    }
+
+    bool hasSamples() {
+      return mCount>0;
+    }
+
+    int count() {
+      return mCount;
+    }
+
+    void addSample(float value) {
+      if (mCount<5) {
+        //  collect the first five samples sorted
+        int i = mCount++;
+
+        while (i>0&&mHeights[i-1]>value) {
+          mHeights[i] = mHeights[i-1];
+          i--;
+        }
+        mHeights[i] = value;
+
+        if (mCount==5)
+          for (int i = 0; i<5; i++) {
+            mPositions[i] = i+1;
+            mDesired[i] = 1+4*desiredIncrement(i);
+          }
+
+        return;
+      }
+
+      mCount++;
+
+      //  find the cell of value, adjust extreme markers
+      int k;
+
+      if (value<mHeights[0]) {
+        mHeights[0] = value;
+        k = 0;
+      } else if (value>=mHeights[4]) {
+        mHeights[4] = value;
+        k = 3;
+      } else
+        for (k = 0; k<3&&value>=mHeights[k+1]; k++)
+          ;
+
+      for (int i = k+1; i<5; i++)
+        mPositions[i]++;
+      for (int i = 0; i<5; i++)
+        mDesired[i] += desiredIncrement(i);
+
+      //  move the middle markers towards their desired positions
+      for (int i = 1; i<4; i++) {
+        float d = mDesired[i]-mPositions[i];
+
+        if ((d>=1&&mPositions[i+1]-mPositions[i]>1)||(d<=-1&&mPositions[i-1]-mPositions[i]<-1)) {
+          int sign = d>0?1:-1;
+          float height = parabolic(i, sign);
+
+          if (mHeights[i-1]<height&&height<mHeights[i+1])
+            mHeights[i] = height;
+          else
+            mHeights[i] += sign*(mHeights[i+sign]-mHeights[i])/(mPositions[i+sign]-mPositions[i]);
+
+          mPositions[i] += sign;
+        }
+      }
+    }
+
+    //  call with hasSamples() true only
+    float value() {
+      if (mCount<5)
+        return mHeights[(int) (mP*(mCount-1)+0.5f)];
+      return mHeights[2];
+    }
+
+  private:
+
+    float mP;
+    int mCount;
+
+    float mHeights[5];
+    int mPositions[5];
+    float mDesired[5];
+
+    //  0, p/2, p, (1+p)/2, 1
+    float desiredIncrement(int i) {
+      static const float factors[5] = { 0, 0.5f, 1, 0.5f, 0 };
+      static const float offsets[5] = { 0, 0, 0, 0.5f, 1 };
+
+      return factors[i]*mP+offsets[i];
+    }
+
+    //  piecewise parabolic prediction of marker i moved by sign
+    float parabolic(int i, int sign) {
+      float nMinus = mPositions[i-1], n = mPositions[i], nPlus = mPositions[i+1];
+
+      return mHeights[i]+sign/(nPlus-nMinus)
+        *((n-nMinus+sign)*(mHeights[i+1]-mHeights[i])/(nPlus-n)
+          +(nPlus-n-sign)*(mHeights[i]-mHeights[i-1])/(n-nMinus));
+    }
+};
+
+//  P50, P90, and P95 over a time window; P² cannot drop old samples, so two sets
+//  of estimators are restarted alternately every mSeconds, staggered by half the
+//  window; the older set covers the last mSeconds/2 to mSeconds
+class WindowQuantiles
+{
+  public:
+
+    WindowQuantiles(const char *name, int seconds) :
+      mEstimators{ { Quantile(0.5f), Quantile(0.9f), Quantile(0.95f) },
+                   { Quantile(0.5f), Quantile(0.9f), Quantile(0.95f) } } {
+      mName = name;
+      mSeconds = seconds;
+      mStarted = false;
+    }
+
+    bool hasSamples() {
+      return mStarted&&mEstimators[older()][0].hasSamples();
+    }
+
+    void addSample(float value) {
+      unsigned long currentMillis = millis();
+
+      if (!mStarted) {
+        //  second set starts half a window late
+        mStartMillis[0] = currentMillis;
+        mStartMillis[1] = currentMillis-mSeconds*500ul;
+        mStarted = true;
+      }
+
+      for (int s = 0; s<2; s++) {
+        if (currentMillis-mStartMillis[s]>=mSeconds*1000ul) {
+          for (int q = 0; q<3; q++)
+            mEstimators[s][q].reset();
+          mStartMillis[s] = currentMillis;
+
+          if (DEBUG)
+            LOG->printf("quantiles %s restarted estimator %d\n", mName, s);
+        }
+
+        for (int q = 0; q<3; q++)
+          mEstimators[s][q].addSample(value);
+      }
+    }
+
+    //  call with hasSamples() true only
+    float p50() {
+      return mEstimators[older()][0].value();
+    }
+
+    float p90() {
+      return mEstimators[older()][1].value();
+    }
+
+    float p95() {
+      return mEstimators[older()][2].value();
+    }
+
+  private:
+
+    const char *mName;
+    int mSeconds;
+    bool mStarted;
+
+    Quantile mEstimators[2][3];
+    unsigned long mStartMillis[2];
+
+    int older() {
+      return mEstimators[0][0].count()>=mEstimators[1][0].count()?0:1;
+    }
+};
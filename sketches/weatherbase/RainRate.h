@@ -0,0 +1,135 @@
+/* --------------------------------------------------------------------------------
+ *  RainRate
+ *  rain intensity from the times of rain gauge tips sent with each packet;
+ *  instantaneous rate from the interval between the latest tips, 10 minute rate
+ *  from the tips in that window, and rain start / stop detection
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+#include "WeatherConfig.h"
+
+#define RAINRATE_CAPACITY 64 // tips kept, covers 10 minutes of heavy rain
+#define RAINRATE_WINDOWSECONDS (10*60)
+#define RAINRATE_STOPSECONDS (30*60) // rain stopped after no tip for this time
+
+class RainRate
+{
+  public:
+
+    RainRate() {
+      mFirst = mCount = 0;
+      mLastPacketMillis = 0;
+      mMMPerTip = 0;
+      mRaining = false;
+      mRainStart = mRainStop = 0;
+    }
+
+    //  call once per packet; mmPerTip from the gauge calibration
+    void addPacket(WeatherPacket &packet, float mmPerTip, time_t now = time(NULL)) {
+      unsigned long currentMillis = millis();
+      int numAges = packet.numRainTipAges();
+
+      mMMPerTip = mmPerTip;
+
+      //  tips without a time are spread between the oldest tip timed and the previous packet
+      int numUntimed = packet.mNumRainTips-numAges;
+
+      if (numUntimed>0) {
+        unsigned long oldest = numAges>0?packet.mRainTipAges[numAges-1]*100ul:0;
+        unsigned long span = mLastPacketMillis&&currentMillis-mLastPacketMillis>oldest
+          ?currentMillis-mLastPacketMillis-oldest:0;
+
+        for (int i = numUntimed; i>0; i--)
+          addTip(currentMillis-oldest-span*i/(numUntimed+1));
+      }
+
+      for (int i = numAges-1; i>=0; i--)
+        addTip(currentMillis-packet.mRainTipAges[i]*100ul);
+
+      mLastPacketMillis = currentMillis;
+
+      //  start / stop detection
+      if (packet.mNumRainTips>0&&!mRaining) {
+        mRaining = true;
+        mRainStart = now-(numAges>0?packet.mRainTipAges[numAges-1]/10:0);
+
+        LOG->println("rain started");
+      } else if (mRaining&&(mCount==0||currentMillis-latestTip()>RAINRATE_STOPSECONDS*1000ul)) {
+        mRaining = false;
+        mRainStop = now-(mCount>0?(currentMillis-latestTip())/1000:0);
+
+        LOG->println("rain stopped");
+      }
+
+      if (DEBUG)
+        LOG->printf("rain rate %.1f mm/h, %.1f mm/h over 10 minutes, %s\n",
+          rate(), windowRate(), mRaining?"raining":"dry");
+    }
+
+    bool raining() {
+      return mRaining;
+    }
+
+    //  0 if unknown
+    time_t rainStart() {
+      return mRainStart;
+    }
+
+    time_t rainStop() {
+      return mRainStop;
+    }
+
+    //  mm/h from the interval between the latest two tips, decaying once the next
+    //  tip is overdue; 0 when dry
+    float rate() {
+      if (!mRaining||mCount<2)
+        return 0;
+
+      unsigned long latest = latestTip();
+      unsigned long interval = latest-tipAt(mCount-2);
+      unsigned long sinceLatest = millis()-latest;
+
+      if (sinceLatest>interval)
+        interval = sinceLatest;
+
+      return interval>0?mMMPerTip*3600000.0f/interval:0;
+    }
+
+    //  mm/h from tips within the last 10 minutes
+    float windowRate() {
+      unsigned long currentMillis = millis();
+      int numTips = 0;
+
+      for (int i = mCount-1; i>=0&&currentMillis-tipAt(i)<=RAINRATE_WINDOWSECONDS*1000ul; i--)
+        numTips++;
+
+      return numTips*mMMPerTip*3600.0f/RAINRATE_WINDOWSECONDS;
+    }
+
+  private:
+
+    unsigned long mTips[RAINRATE_CAPACITY]; // millis, oldest first
+    int mFirst, mCount;
+    unsigned long mLastPacketMillis;
+    float mMMPerTip;
+
+    bool mRaining;
+    time_t mRainStart, mRainStop;
+
+    unsigned long tipAt(int i) {
+      return mTips[(mFirst+i)%RAINRATE_CAPACITY];
+    }
+
+    unsigned long latestTip() {
+      return tipAt(mCount-1);
+    }
+
+    void addTip(unsigned long tipMillis) {
+      if (mCount>=RAINRATE_CAPACITY) {
+        mFirst = (mFirst+1)%RAINRATE_CAPACITY;
+        mCount--;
+      }
+
+      mTips[(mFirst+mCount++)%RAINRATE_CAPACITY] = tipMillis;
+    }
+};
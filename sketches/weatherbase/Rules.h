@@ -0,0 +1,208 @@
+/* --------------------------------------------------------------------------------
+ *  Rules
+ *  threshold alerts defined in RULES_PATH on SPIFFS, compiled into a flat table
+ *  when loaded and evaluated once per packet; a rule fires when its condition
+ *  becomes true, sending an openHAB item command or calling a webhook
+ *
+ *  one rule per line, e.g.
+ *    gusts > 15 item Weather_GustAlert ON
+ *    temperature < 0 item Weather_Frost ON
+ *    raining == 1 webhook http://192.168.1.10/hook?event=rain
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+#include <SPIFFS.h>
+
+#include "WeatherConfig.h"
+
+#define RULES_PATH "/rules.txt"
+#define RULES_MAXRULES 16
+#define RULES_TARGETSIZE 96 // item name or URL
+#define RULES_PAYLOADSIZE 16
+
+//  values rules may refer to, set per packet by the sketch
+enum RuleVariable {
+  TemperatureVariable, // degree Celsius
+  HumidityVariable, // %
+  PressureVariable, // hPa
+  WindVariable, // m/s, 10 minute average
+  GustsVariable, // m/s, 10 minute maximum
+  RainRateVariable, // mm/h
+  RainTodayVariable, // mm
+  RainingVariable, // 0 or 1
+  DewPointVariable, // degree Celsius
+  BatteryVariable, // %
+  NumRuleVariables
+};
+
+class Rules
+{
+  public:
+
+    Rules() {
+      mNumRules = 0;
+    }
+
+    static const char *variableName(int variable) {
+      static const char *names[NumRuleVariables] = {
+        "temperature", "humidity", "pressure", "wind", "gusts",
+        "rainrate", "rainday", "raining", "dewpoint", "battery"
+      };
+
+      return names[variable];
+    }
+
+    //  (re)load RULES_PATH, returns the number of lines rejected
+    int load() {
+      File file = SPIFFS.open(RULES_PATH, FILE_READ);
+      int numErrors = 0, lineNumber = 0;
+
+      mNumRules = 0;
+
+      if (!file) {
+        LOG->printf("rules: no %s, no rules active\n", RULES_PATH);
+        return 0;
+      }
+
+      while (file.available()) {
+        String line = file.readStringUntil('\n');
+
+        lineNumber++;
+        line.trim();
+        if (line.length()==0||line[0]=='#')
+          continue;
+
+        if (mNumRules>=RULES_MAXRULES||!compile(line.c_str(), mRules[mNumRules])) {
+          LOG->printf("rules: line %d rejected: %s\n", lineNumber, line.c_str());
+          numErrors++;
+        } else
+          mNumRules++;
+      }
+
+      file.close();
+
+      LOG->printf("rules: %d rules loaded from %s\n", mNumRules, RULES_PATH);
+
+      return numErrors;
+    }
+
+    int numRules() {
+      return mNumRules;
+    }
+
+    //  call once per packet, values UNDEFINEDVALUE if unknown; rules on unknown values
+    //  keep their state
+    void evaluate(const float *values) {
+      for (int i = 0; i<mNumRules; i++) {
+        Rule &rule = mRules[i];
+        float value = values[rule.variable];
+
+        if (value==UNDEFINEDVALUE)
+          continue;
+
+        bool holds = compare(value, rule.comparison, rule.threshold);
+
+        if (holds&&!rule.active) {
+          LOG->printf("rules: %s %s %.1f fired at %.1f\n",
+            variableName(rule.variable), comparisonName(rule.comparison), rule.threshold, value);
+          fire(rule);
+        }
+
+        rule.active = holds;
+      }
+    }
+
+    void print(Print *p) {
+      for (int i = 0; i<mNumRules; i++) {
+        Rule &rule = mRules[i];
+
+        p->printf("%s %s %g %s %s %s (%s)\n",
+          variableName(rule.variable), comparisonName(rule.comparison), rule.threshold,
+          rule.action==ItemAction?"item":"webhook", rule.target, rule.payload,
+          rule.active?"active":"inactive");
+      }
+    }
+
+  private:
+
+    enum Comparison {
+      Less, LessEqual, Greater, GreaterEqual, Equal, NotEqual, NumComparisons
+    };
+
+    enum Action {
+      ItemAction, // sendItemCommand(target, payload)
+      WebhookAction // GET target
+    };
+
+    struct Rule {
+      uint8_t variable;
+      uint8_t comparison;
+      uint8_t action;
+      bool active; // condition held on the last evaluation
+      float threshold;
+      char target[RULES_TARGETSIZE];
+      char payload[RULES_PAYLOADSIZE];
+    };
+
+    Rule mRules[RULES_MAXRULES];
+    int mNumRules;
+
+    static const char *comparisonName(int comparison) {
+      static const char *names[NumComparisons] = { "<", "<=", ">", ">=", "==", "!=" };
+
+      return names[comparison];
+    }
+
+    static bool compare(float value, int comparison, float threshold) {
+      switch (comparison) {
+        case Less: return value<threshold;
+        case LessEqual: return value<=threshold;
+        case Greater: return value>threshold;
+        case GreaterEqual: return value>=threshold;
+        case Equal: return value==threshold;
+        default: return value!=threshold;
+      }
+    }
+
+    //  "variable comparison threshold item|webhook target [payload]"
+    static bool compile(const char *line, Rule &rule) {
+      char variable[16], comparison[3], action[8];
+      int numFields;
+
+      rule.payload[0] = '\0';
+      numFields = sscanf(line, "%15s %2s %f %7s %95s %15s",
+        variable, comparison, &rule.threshold, action, rule.target, rule.payload);
+
+      if (numFields<5)
+        return false;
+
+      rule.variable = NumRuleVariables;
+      for (int v = 0; v<NumRuleVariables; v++)
+        if (strcmp(variable, variableName(v))==0)
+          rule.variable = v;
+
+      rule.comparison = NumComparisons;
+      for (int c = 0; c<NumComparisons; c++)
+        if (strcmp(comparison, comparisonName(c))==0)
+          rule.comparison = c;
+
+      if (strcmp(action, "item")==0&&numFields==6)
+        rule.action = ItemAction;
+      else if (strcmp(action, "webhook")==0)
+        rule.action = WebhookAction;
+      else
+        return false;
+
+      //  conditions true at load time fire with the first packet
+      rule.active = false;
+
+      return rule.variable<NumRuleVariables&&rule.comparison<NumComparisons;
+    }
+
+    static void fire(const Rule &rule) {
+      if (rule.action==ItemAction)
+        Bolbro.sendItemCommand(rule.target, rule.payload);
+      else
+        Bolbro.callURL(rule.target);
+    }
+};
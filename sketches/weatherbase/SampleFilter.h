@@ -0,0 +1,146 @@
+/* --------------------------------------------------------------------------------
+ *  SampleFilter
+ *  reject implausible samples of a channel before aggregation: plausibility
+ *  bounds, a rate of change limit, and deviation from the median of the last
+ *  FILTER_MEDIANSIZE samples accepted; constant time and memory per sample
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+#include "WeatherConfig.h"
+
+#define FILTER_MEDIANSIZE 5
+#define FILTER_RESYNC 3 // consecutive rejections accepted as a real change
+#define FILTER_UNLIMITED 0.0f // no rate or spike limit
+
+//  constructor arguments of a filter, see FilterLimits.h
+struct SampleFilterLimits {
+  const char *name;
+  float minValue, maxValue;
+  float maxChangePerMinute, maxDeviation;
+};
+
+class SampleFilter
+{
+  public:
+
+    enum Result {
+      Accepted,
+      OutOfBounds,
+      TooFast, // rate of change exceeded
+      Spike // too far from median
+    };
+
+    SampleFilter(const SampleFilterLimits &limits) :
+      SampleFilter(limits.name, limits.minValue, limits.maxValue, limits.maxChangePerMinute, limits.maxDeviation) {
+    }
+
+    //  maxChangePerMinute and maxDeviation may be FILTER_UNLIMITED
+    SampleFilter(const char *name, float minValue, float maxValue,
+      float maxChangePerMinute, float maxDeviation) {
+      mName = name;
+      mMinValue = minValue;
+      mMaxValue = maxValue;
+      mMaxChangePerMinute = maxChangePerMinute;
+      mMaxDeviation = maxDeviation;
+
+      mCount = mNext = 0;
+      mLastMillis = 0;
+      mConsecutiveRejections = 0;
+
+      for (int i = 0; i<4; i++)
+        mCounters[i] = 0;
+    }
+
+    //  true if value may be aggregated
+    bool accept(float value) {
+      Result result = check(value);
+
+      if (result!=Accepted&&result!=OutOfBounds&&++mConsecutiveRejections>=FILTER_RESYNC) {
+        //  persistent change, e.g. after the station has been offline; start over
+        LOG->printf("filter %s resyncs to %.2f\n", mName, value);
+        mCount = 0;
+        result = Accepted;
+      }
+
+      mCounters[result]++;
+
+      if (result==Accepted) {
+        mConsecutiveRejections = 0;
+        mLastValue = value;
+        mLastMillis = millis();
+        mRecent[mNext] = value;
+        mNext = (mNext+1)%FILTER_MEDIANSIZE;
+        if (mCount<FILTER_MEDIANSIZE)
+          mCount++;
+      } else
+        LOG->printf("filter %s rejected %.2f (%s)\n", mName, value, resultName(result));
+
+      return result==Accepted;
+    }
+
+    const char *name() {
+      return mName;
+    }
+
+    unsigned long count(Result result) {
+      return mCounters[result];
+    }
+
+    static const char *resultName(Result result) {
+      static const char *names[] = { "accepted", "bounds", "rate", "spike" };
+
+      return names[result];
+    }
+
+  private:
+
+    const char *mName;
+    float mMinValue, mMaxValue;
+    float mMaxChangePerMinute, mMaxDeviation;
+
+    float mRecent[FILTER_MEDIANSIZE]; // samples accepted, ring
+    int mCount, mNext;
+    float mLastValue;
+    unsigned long mLastMillis;
+    int mConsecutiveRejections;
+
+    unsigned long mCounters[4]; // per Result
+
+    Result check(float value) {
+      if (isnan(value)||value<mMinValue||value>mMaxValue)
+        return OutOfBounds;
+
+      if (mCount==0)
+        return Accepted;
+
+      if (mMaxChangePerMinute!=FILTER_UNLIMITED) {
+        float minutes = (millis()-mLastMillis)/60000.0f;
+
+        //  allow at least one minute's change, reports may come in quickly
+        if (fabs(value-mLastValue)>mMaxChangePerMinute*(minutes<1.0f?1.0f:minutes))
+          return TooFast;
+      }
+
+      if (mMaxDeviation!=FILTER_UNLIMITED&&mCount==FILTER_MEDIANSIZE
+          &&fabs(value-median())>mMaxDeviation)
+        return Spike;
+
+      return Accepted;
+    }
+
+    //  median of five by sorting a copy, fixed cost
+    float median() {
+      float sorted[FILTER_MEDIANSIZE];
+
+      memcpy(sorted, mRecent, sizeof(sorted));
+
+      for (int i = 1; i<FILTER_MEDIANSIZE; i++)
+        for (int j = i; j>0&&sorted[j-1]>sorted[j]; j--) {
+          float swap = sorted[j];
+          sorted[j] = sorted[j-1];
+          sorted[j-1] = swap;
+        }
+
+      return sorted[FILTER_MEDIANSIZE/2];
+    }
+};
@@ -393,3 +393,21 @@ bool calcSun (float *azimuthP, float *inclinationP)
 
   return result;
 }
+
+float calcDayLength (time_t t)
+{
+  float result = 0;
+  double phi_g = deg2rad (LATITUDE);
+  double lambda = deg2rad (LONGITUDE);
+  double delta;
+  double omega_sr, omega_ss;
+  int julian_day;
+  struct tm *dateTime = gmtime(&t);
+
+  if (make_julian_day (dateTime->tm_mday, dateTime->tm_mon+1, dateTime->tm_year+1900, &julian_day)==0
+      &&declination_sun (dateTime->tm_year+1900, julian_day, lambda, &delta)==0
+      &&sunrise_hour_angle (phi_g, delta, -1.0, &omega_sr, &omega_ss)==0)
+    result = rad2deg (omega_ss-omega_sr)/15.0; // 15 degree per hour
+
+  return result;
+}
@@ -1,3 +1,4 @@
 #include <Arduino.h>
 
 extern bool calcSun (float *azimuthP, float *inclinationP);
+extern float calcDayLength (time_t t); // hours from sunrise to sunset on the day of t
@@ -0,0 +1,189 @@
+/* --------------------------------------------------------------------------------
+ *  WindVector
+ *  mean wind direction over a time window from running sums of unit vectors,
+ *  avoiding the wrap around at north, plus a daily speed weighted wind rose;
+ *  directions are the 16 bins of the wind vane (see WeatherPacket::windDirectionIndex)
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+#include "WeatherConfig.h"
+
+//  requires DailyMinMax.h for day boundaries
+
+#define WINDVECTOR_NUMBINS 16
+#define WINDVECTOR_CAPACITY 64 // samples in window, oldest dropped if exceeded
+#define WINDVECTOR_SCALE 10000 // unit vectors as integers keep sums exact on expiry
+
+class WindVector
+{
+  public:
+
+    WindVector(const char *name, int seconds) {
+      mName = name;
+      mSeconds = seconds;
+      mFirst = mCount = 0;
+      mSumX = mSumY = 0;
+    }
+
+    bool hasSamples() {
+      return mCount>0;
+    }
+
+    void addSample(int bin) {
+      if (bin<0||bin>=WINDVECTOR_NUMBINS)
+        return;
+
+      unsigned long currentMillis = millis();
+
+      expire(currentMillis);
+
+      if (mCount>=WINDVECTOR_CAPACITY)
+        remove();
+
+      Sample &sample = mSamples[(mFirst+mCount++)%WINDVECTOR_CAPACITY];
+
+      sample.time = currentMillis;
+      sample.bin = bin;
+      mSumX += unitX(bin);
+      mSumY += unitY(bin);
+
+      if (DEBUG)
+        LOG->printf("wind vector %s added bin %d, mean %.0f degree, steadiness %.2f\n",
+          mName, bin, meanDegrees(), steadiness());
+    }
+
+    //  call with hasSamples() true only; clockwise from north, 0..360
+    float meanDegrees() {
+      float degrees = atan2((float) mSumX, (float) mSumY)*180.0f/M_PI;
+
+      return degrees<0?degrees+360.0f:degrees;
+    }
+
+    //  nearest of the 16 bins
+    int meanBin() {
+      return ((int) (meanDegrees()/22.5f+0.5f))%WINDVECTOR_NUMBINS;
+    }
+
+    //  length of the mean vector, 1 for constant direction, about 0 for variable wind
+    float steadiness() {
+      if (mCount==0)
+        return 0;
+
+      return sqrtf((float) mSumX*mSumX+(float) mSumY*mSumY)/(mCount*(float) WINDVECTOR_SCALE);
+    }
+
+  private:
+
+    const char *mName;
+    int mSeconds;
+
+    struct Sample {
+      unsigned long time;
+      int8_t bin;
+    } mSamples[WINDVECTOR_CAPACITY];
+    int mFirst, mCount;
+    long mSumX, mSumY; // east and north components
+
+    static int16_t unitX(int bin) {
+      static const int16_t sines[WINDVECTOR_NUMBINS] = {
+        0, 3827, 7071, 9239, 10000, 9239, 7071, 3827,
+        0, -3827, -7071, -9239, -10000, -9239, -7071, -3827
+      };
+
+      return sines[bin];
+    }
+
+    static int16_t unitY(int bin) {
+      return unitX((bin+4)%WINDVECTOR_NUMBINS); // cosine
+    }
+
+    void remove() {
+      Sample &sample = mSamples[mFirst];
+
+      mSumX -= unitX(sample.bin);
+      mSumY -= unitY(sample.bin);
+      mFirst = (mFirst+1)%WINDVECTOR_CAPACITY;
+      mCount--;
+    }
+
+    void expire(unsigned long currentMillis) {
+      while (mCount>0&&currentMillis-mSamples[mFirst].time>mSeconds*1000ul)
+        remove();
+    }
+};
+
+//  wind speed per direction of the current day
+class WindRose
+{
+  public:
+
+    WindRose() {
+      mNextDaySeconds = 0;
+      mStartOfDaySeconds = 0;
+      reset();
+    }
+
+    void addSample(int bin, float speedMpS, time_t now = time(NULL)) {
+      if (bin<0||bin>=WINDVECTOR_NUMBINS||speedMpS==UNDEFINEDVALUE)
+        return;
+
+      checkRollover(now);
+
+      mSpeedSums[bin] += speedMpS;
+      mCounts[bin]++;
+      mTotalSpeed += speedMpS;
+      mTotalCount++;
+    }
+
+    void checkRollover(time_t now = time(NULL)) {
+      if (now<mNextDaySeconds)
+        return;
+
+      struct tm today;
+
+      mStartOfDaySeconds = DailyMinMax::startOfDaySeconds(now, &today);
+      mNextDaySeconds = DailyMinMax::nextDaySeconds(today);
+      reset();
+    }
+
+    bool hasSamples() {
+      return mTotalCount>0;
+    }
+
+    time_t since() {
+      return mStartOfDaySeconds;
+    }
+
+    long count(int bin) {
+      return mCounts[bin];
+    }
+
+    //  call with count(bin)>0 only
+    float avgSpeed(int bin) {
+      return mSpeedSums[bin]/mCounts[bin];
+    }
+
+    //  share of the day's wind run from direction bin, 0..1
+    float share(int bin) {
+      return mTotalSpeed>0?mSpeedSums[bin]/mTotalSpeed:0;
+    }
+
+  private:
+
+    float mSpeedSums[WINDVECTOR_NUMBINS];
+    long mCounts[WINDVECTOR_NUMBINS];
+    float mTotalSpeed;
+    long mTotalCount;
+
+    time_t mNextDaySeconds;
+    time_t mStartOfDaySeconds;
+
+    void reset() {
+      for (int i = 0; i<WINDVECTOR_NUMBINS; i++) {
+        mSpeedSums[i] = 0;
+        mCounts[i] = 0;
+      }
+      mTotalSpeed = 0;
+      mTotalCount = 0;
+    }
+};
@@ -0,0 +1,138 @@
+/* --------------------------------------------------------------------------------
+ *  Zambretti
+ *  local short term forecast from sea level pressure, its 3 hour trend, wind
+ *  direction, and season, following the Zambretti forecaster as published by
+ *  beteljuice (http://www.beteljuice.co.uk/zambretti/forecast.html)
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+#include "WeatherConfig.h"
+
+#define ZAMBRETTI_TOP 1050.0f // hPa, range covered by the forecaster
+#define ZAMBRETTI_BOTTOM 950.0f
+#define ZAMBRETTI_TRENDLIMIT 1.6f // hPa/3h, steady within +/- this
+
+class Zambretti
+{
+  public:
+
+    Zambretti() {
+      mLetter = 0;
+      mExceptional = false;
+    }
+
+    //  pressure at station level, trend in hPa/3h, wind bin 0..15 (N..NNW) or -1,
+    //  month 0..11; call once per packet
+    void update(float pressureHPA, float temperatureDegreeCelsius, float trendHPAPer3h,
+      int windBin, int month) {
+      static const float windAdjustments[16] = {
+        6, 5, 5, 2, -0.5f, -2, -5, -8.5f, -12, -10, -6, -4.5f, -3, -0.5f, 1.5f, 3
+      };
+      static const uint8_t rising[22] = {
+        25, 25, 25, 24, 24, 19, 16, 12, 11, 9, 8, 6, 5, 2, 1, 1, 0, 0, 0, 0, 0, 0
+      };
+      static const uint8_t steady[22] = {
+        25, 25, 25, 25, 25, 25, 23, 23, 22, 18, 15, 13, 10, 4, 1, 1, 0, 0, 0, 0, 0, 0
+      };
+      static const uint8_t falling[22] = {
+        25, 25, 25, 25, 25, 25, 25, 25, 23, 23, 21, 20, 17, 14, 7, 3, 1, 1, 1, 0, 0, 0
+      };
+
+      if (pressureHPA==UNDEFINEDVALUE) {
+        mLetter = 0;
+        return;
+      }
+
+      const float range = ZAMBRETTI_TOP-ZAMBRETTI_BOTTOM;
+      float hpa = seaLevelPressure(pressureHPA, temperatureDegreeCelsius);
+      bool southern = LATITUDE<0;
+      bool summer = (month>=3&&month<=8)!=southern; // April to September in the north
+
+      if (windBin>=0&&windBin<16)
+        hpa += windAdjustments[southern?(windBin+8)%16:windBin]*range/100;
+
+      const uint8_t *options;
+
+      if (trendHPAPer3h>ZAMBRETTI_TRENDLIMIT) {
+        if (summer)
+          hpa += 7*range/100;
+        options = rising;
+      } else if (trendHPAPer3h<-ZAMBRETTI_TRENDLIMIT) {
+        if (!summer)
+          hpa -= 7*range/100;
+        options = falling;
+      } else
+        options = steady;
+
+      int option = floor((hpa-ZAMBRETTI_BOTTOM)/(range/22));
+
+      mExceptional = option<0||option>21;
+      option = constrain(option, 0, 21);
+      mLetter = 'A'+options[option];
+
+      if (DEBUG)
+        LOG->printf("zambretti forecast %c (%s) for %.1f hPa at sea level, trend %.1f hPa/3h\n",
+          mLetter, text(), hpa, trendHPAPer3h);
+    }
+
+    bool valid() {
+      return mLetter!=0;
+    }
+
+    //  A (settled fine) to Z (stormy, much rain)
+    char letter() {
+      return mLetter;
+    }
+
+    //  German text, HTML encoded
+    const char *text() {
+      static const char *texts[26] = {
+        "Best&auml;ndig sch&ouml;n",
+        "Sch&ouml;n",
+        "Wird sch&ouml;n",
+        "Sch&ouml;n, wird unbest&auml;ndiger",
+        "Sch&ouml;n, m&ouml;glicherweise Schauer",
+        "Ziemlich sch&ouml;n, Besserung",
+        "Ziemlich sch&ouml;n, anfangs m&ouml;glicherweise Schauer",
+        "Ziemlich sch&ouml;n, sp&auml;ter Schauer",
+        "Anfangs Schauer, Besserung",
+        "Wechselhaft, Besserung",
+        "Ziemlich sch&ouml;n, wahrscheinlich Schauer",
+        "Eher unbest&auml;ndig, sp&auml;ter aufklarend",
+        "Unbest&auml;ndig, wahrscheinlich Besserung",
+        "Schauer, heitere Abschnitte",
+        "Schauer, wird unbest&auml;ndiger",
+        "Wechselhaft, etwas Regen",
+        "Unbest&auml;ndig, kurze sch&ouml;ne Abschnitte",
+        "Unbest&auml;ndig, sp&auml;ter Regen",
+        "Unbest&auml;ndig, etwas Regen",
+        "&Uuml;berwiegend sehr unbest&auml;ndig",
+        "Gelegentlich Regen, Verschlechterung",
+        "Zeitweise Regen, sehr unbest&auml;ndig",
+        "H&auml;ufig Regen",
+        "Regen, sehr unbest&auml;ndig",
+        "St&uuml;rmisch, eventuell Besserung",
+        "St&uuml;rmisch, viel Regen"
+      };
+
+      return valid()?texts[mLetter-'A']:"";
+    }
+
+    //  pressure outside the range covered by the forecaster
+    bool exceptional() {
+      return mExceptional;
+    }
+
+    //  reduce station pressure to sea level (barometric formula, ALTITUDE in m)
+    static float seaLevelPressure(float pressureHPA, float temperatureDegreeCelsius) {
+      if (temperatureDegreeCelsius==UNDEFINEDVALUE)
+        temperatureDegreeCelsius = 15.0f; // standard atmosphere
+
+      return pressureHPA*pow(1.0f-0.0065f*ALTITUDE/(temperatureDegreeCelsius+0.0065f*ALTITUDE+273.15f), -5.257f);
+    }
+
+  private:
+
+    char mLetter; // 0 if not computed yet
+    bool mExceptional;
+};
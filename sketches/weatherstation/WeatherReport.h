@@ -21,6 +21,12 @@ class WeatherReport {
       mPacket.mDeltaRainMM = rainMM;
     }
 
+    //  tips since last report, ages in 1/10 s of the most recent ones, most recent first
+    void setRainTips(unsigned int numTips, const uint16_t *ages) {
+      mPacket.mNumRainTips = numTips<255?numTips:255;
+      memcpy(mPacket.mRainTipAges, ages, mPacket.numRainTipAges()*sizeof(uint16_t));
+    }
+
     bool hasTemperature() {
       return mPacket.mTemperatureDegreeCelsius!=UNDEFINEDVALUE;
     }
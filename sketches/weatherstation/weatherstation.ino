@@ -2,6 +2,7 @@
 //  system libraries
 #include <limits.h>
 #include <math.h>
+#include <sys/time.h>
 
 //  temperature sensor
 #include <Wire.h>
@@ -44,6 +45,10 @@ RTC_DATA_ATTR unsigned int numRainBuckets = 0;
 RTC_DATA_ATTR bool rainBucketOperational = true; // bucket is *not* horizontal permanently
 RTC_DATA_ATTR unsigned int lastNumRainBucketsReported = 0;
 
+//  ring of the most recent tip times in ms, the RTC keeps time during deep sleep
+RTC_DATA_ATTR int64_t rainTipMillis[MAX_RAIN_TIPS];
+RTC_DATA_ATTR unsigned int nextRainTip = 0;
+
 /****************************************************************************************************
   deep sleep wakeup status
  ****************************************************************************************************/
@@ -351,13 +356,21 @@ static void propagateWindDirection(WeatherReport &report) {
 #endif // USE_WIND_REED
 
 #if USE_RAIN
-const double gaugeDiameter = 106; // mm
-const double gaugeArea = M_PI*(gaugeDiameter/2)*(gaugeDiameter/2); // mm2
+const double gaugeArea = M_PI*(RAIN_GAUGE_DIAMETER/2)*(RAIN_GAUGE_DIAMETER/2); // mm2
+
+static int64_t rtcMillis() {
+  struct timeval now;
+
+  gettimeofday(&now, NULL);
+
+  return (int64_t) now.tv_sec*1000+now.tv_usec/1000;
+}
 
 static void handleRainState() {
   //  called after ext0 wakeup, increment
   if (rainBucketOperational) {
     numRainBuckets++;
+    rainTipMillis[nextRainTip++%MAX_RAIN_TIPS] = rtcMillis();
 #if DEBUG
     Serial.print("increased number of rain buckets to ");
     Serial.println(numRainBuckets);
@@ -401,6 +414,18 @@ static void propagateRain(WeatherReport &report) {
   //  rainMM is the rain in mm we got since last time propagateRain has been called
   report.setDeltaRain(deltaRainMM);
 
+  //  ages of the most recent tips, allows the base to calculate rain intensity
+  uint16_t ages[MAX_RAIN_TIPS];
+  int64_t now = rtcMillis();
+
+  for (unsigned int i = 0; i<numDeltaBuckets&&i<MAX_RAIN_TIPS; i++) {
+    int64_t age = (now-rainTipMillis[(nextRainTip-1-i)%MAX_RAIN_TIPS])/100;
+
+    ages[i] = age<0?0:age>UINT16_MAX?UINT16_MAX:age;
+  }
+
+  report.setRainTips(numDeltaBuckets, ages);
+
   //  memorize current rain buckets to allow a delta calculation for the next call
   lastNumRainBucketsReported = numRainBuckets;
 }
@@ -0,0 +1,162 @@
+/* --------------------------------------------------------------------------------
+ *  archivebench
+ *  host benchmark for the archive block codec used by weatherbase, encodes a
+ *  synthetic series of readings (or decodes an archive file copied from the
+ *  base) and reports size per reading and decoder throughput
+ *
+ *  build and run:
+ *    c++ -O2 -std=c++11 -o archivebench tools/archivebench/archivebench.cpp
+ *    ./archivebench [-n readings] [archive.bin]
+ *
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <chrono>
+#include <random>
+#include <vector>
+
+#include "../../sketches/weatherbase/ArchiveBlock.h"
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+}
+
+//  readings as the station sends them: low pass filtered floats every ~20 s
+static std::vector<ArchiveRecord> syntheticReadings(long numReadings) {
+  std::vector<ArchiveRecord> readings(numReadings);
+  std::mt19937 random(4711);
+  std::normal_distribution<float> noise(0.0f, 1.0f);
+  std::uniform_int_distribution<int> jitter(-1, 1);
+
+  uint32_t time = 1700000000;
+  float temperature = 12.0f, pressure = 1013.0f, humidity = 70.0f, battery = 4.1f;
+  float windSpeed = 3.0f, windDirection = 10.0f;
+
+  for (long i = 0; i<numReadings; i++) {
+    ArchiveRecord &record = readings[i];
+
+    time += 20+jitter(random);
+    temperature = temperature*0.9f+(12.0f+6.0f*sinf(i*2*M_PI/4320)+0.3f*noise(random))*0.1f;
+    pressure = pressure*0.9f+(1013.0f+8.0f*sinf(i*2*M_PI/30000)+0.2f*noise(random))*0.1f;
+    humidity = humidity*0.9f+(70.0f-10.0f*sinf(i*2*M_PI/4320)+noise(random))*0.1f;
+    battery = battery*0.5f+(4.1f+0.01f*noise(random))*0.5f;
+    windSpeed = fabsf(windSpeed+0.5f*noise(random));
+    if (random()%10==0)
+      windDirection = (int) (windDirection+16+jitter(random))%16;
+
+    record.time = time;
+    record.values[TemperatureChannel] = temperature;
+    record.values[PressureChannel] = pressure;
+    record.values[HumidityChannel] = humidity;
+    record.values[WindSpeedChannel] = windSpeed;
+    record.values[WindDirectionChannel] = windDirection;
+    record.values[RainChannel] = random()%50==0?0.35f*(1+random()%3):0.0f;
+    record.values[BatteryChannel] = battery;
+  }
+
+  return readings;
+}
+
+static std::vector<ArchiveBlock> encode(const std::vector<ArchiveRecord> &readings) {
+  std::vector<ArchiveBlock> blocks(1);
+
+  for (const ArchiveRecord &record : readings) {
+    if (!blocks.back().append(record)) {
+      blocks.emplace_back();
+      blocks.back().append(record);
+    }
+  }
+
+  return blocks;
+}
+
+static std::vector<ArchiveBlock> load(const char *path) {
+  std::vector<ArchiveBlock> blocks;
+  FILE *file = fopen(path, "rb");
+
+  if (!file) {
+    perror(path);
+    exit(1);
+  }
+
+  ArchiveBlock block;
+
+  while (fread(block.bytes(), 1, ARCHIVE_BLOCKSIZE, file)==ARCHIVE_BLOCKSIZE)
+    if (block.valid())
+      blocks.push_back(block);
+
+  fclose(file);
+
+  return blocks;
+}
+
+int main(int argc, char **argv) {
+  long numReadings = 1000000;
+  const char *path = NULL;
+
+  for (int i = 1; i<argc; i++) {
+    if (strcmp(argv[i], "-n")==0&&i+1<argc)
+      numReadings = atol(argv[++i]);
+    else if (argv[i][0]=='-') {
+      fprintf(stderr, "usage: %s [-n readings] [archive.bin]\n", argv[0]);
+      return 1;
+    } else
+      path = argv[i];
+  }
+
+  std::vector<ArchiveRecord> readings;
+  std::vector<ArchiveBlock> blocks;
+
+  if (path)
+    blocks = load(path);
+  else {
+    readings = syntheticReadings(numReadings);
+
+    auto start = std::chrono::steady_clock::now();
+    blocks = encode(readings);
+    double seconds = secondsSince(start);
+
+    printf("encoded %ld readings in %.3f s, %.1f M readings/s\n",
+      numReadings, seconds, numReadings/seconds/1e6);
+  }
+
+  //  decode everything, verify against the quantized source in the synthetic case
+  for (ArchiveRecord &record : readings)
+    for (int c = 0; c<NumArchiveChannels; c++)
+      record.values[c] = ArchiveBlock::quantize(c, record.values[c]);
+
+  long numDecoded = 0, numMismatches = 0;
+  double checksum = 0;
+  auto start = std::chrono::steady_clock::now();
+
+  for (const ArchiveBlock &block : blocks) {
+    ArchiveBlockReader reader(block);
+    ArchiveRecord record;
+
+    while (reader.next(record)) {
+      if (!readings.empty()
+          &&memcmp(&record, &readings[numDecoded], sizeof(ArchiveRecord))!=0)
+        numMismatches++;
+      checksum += record.values[TemperatureChannel];
+      numDecoded++;
+    }
+  }
+
+  double seconds = secondsSince(start);
+  double bytes = (double) blocks.size()*ARCHIVE_BLOCKSIZE;
+
+  printf("decoded %ld readings from %zu blocks in %.3f s, %.1f M readings/s, %.1f MB/s (checksum %.1f)\n",
+    numDecoded, blocks.size(), seconds, numDecoded/seconds/1e6, bytes/seconds/1e6, checksum);
+  printf("%.2f bytes per reading (%.2f bytes raw), %.1f readings per block\n",
+    bytes/numDecoded, (double) sizeof(ArchiveRecord), (double) numDecoded/blocks.size());
+
+  if (numMismatches) {
+    printf("%ld readings did not survive the round trip\n", numMismatches);
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+# --------------------------------------------------------------------------------
+#  embedassets
+#  gzips the web content of a sketch's data folder and writes it as const arrays
+#  to a header, served from flash by BolbroWebServer::sendAsset() instead of SPIFFS
+#
+#  run from the repository root before compiling weatherbase:
+#    python3 tools/embedassets.py sketches/weatherbase/data sketches/weatherbase/WebAssets.h
+#
+#  files are stored uncompressed if gzip does not make them smaller (PNG); the ETag
+#  is a hash of the content, HTML is revalidated on every load, everything else is
+#  cached as immutable; paths are indexed by a perfect hash, a seed for FNV-1a
+#  mapping every path to a slot of its own (see BolbroWebServer::hashPath())
+#  Harald Schlangmann, October 2026
+# --------------------------------------------------------------------------------
+
+import gzip
+import hashlib
+import os
+import sys
+
+MIMETYPES = {
+    ".html": "text/html",
+    ".htm": "text/html",
+    ".css": "text/css",
+    ".js": "application/javascript",
+    ".png": "image/png",
+    ".gif": "image/gif",
+    ".jpg": "image/jpeg",
+    ".ico": "image/x-icon",
+}
+
+REVALIDATE = "no-cache"
+IMMUTABLE = "public, max-age=31536000, immutable"
+
+
+def asset(dataDir, name):
+    with open(os.path.join(dataDir, name), "rb") as f:
+        content = f.read()
+
+    extension = os.path.splitext(name)[1].lower()
+    compressed = gzip.compress(content, compresslevel=9, mtime=0)
+    gzipped = len(compressed) < len(content)
+
+    return {
+        "path": "/" + name,
+        "mimeType": MIMETYPES[extension],
+        "data": compressed if gzipped else content,
+        "gzipped": gzipped,
+        "eTag": '"' + hashlib.sha256(content).hexdigest()[:16] + '"',
+        "cacheControl": REVALIDATE if MIMETYPES[extension] == "text/html" else IMMUTABLE,
+        "originalSize": len(content),
+    }
+
+
+def hashPath(path, seed):
+    h = 2166136261 ^ seed
+    for c in path.encode():
+        h = ((h ^ c) * 16777619) & 0xffffffff
+    return h ^ (h >> 16)
+
+
+#   at least twice as many slots as paths, so a seed is found after a few hundred tries
+def perfectHash(paths):
+    numSlots = 1
+    while numSlots < 2 * len(paths):
+        numSlots *= 2
+
+    for seed in range(1 << 24):
+        slots = [-1] * numSlots
+        for i, path in enumerate(paths):
+            slot = hashPath(path, seed) & (numSlots - 1)
+            if slots[slot] >= 0:
+                break
+            slots[slot] = i
+        else:
+            return seed, slots
+
+    sys.exit("no perfect hash found")
+
+
+def cString(s):
+    return '"' + s.replace("\\", "\\\\").replace('"', '\\"') + '"'
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit("usage: embedassets.py datadir header")
+
+    dataDir, headerPath = sys.argv[1], sys.argv[2]
+    names = sorted(name for name in os.listdir(dataDir)
+        if os.path.splitext(name)[1].lower() in MIMETYPES)
+    assets = [asset(dataDir, name) for name in names]
+
+    lines = [
+        "//",
+        "//  generated by tools/embedassets.py from %s, do not edit" % dataDir,
+        "//",
+        "",
+        "#include <BolbroWebServer.h>",
+        "",
+    ]
+
+    for i, a in enumerate(assets):
+        data = a["data"]
+        lines.append("//  %s, %d bytes%s" % (a["path"], a["originalSize"],
+            ", %d gzipped" % len(data) if a["gzipped"] else ""))
+        lines.append("static const uint8_t webAssetData%d[] PROGMEM = {" % i)
+        for offset in range(0, len(data), 16):
+            lines.append("  " + ", ".join("0x%02x" % b for b in data[offset:offset+16]) + ",")
+        lines.append("};")
+        lines.append("")
+
+    lines.append("#define NUMWEBASSETS %d" % len(assets))
+    lines.append("")
+    lines.append("static const BolbroAsset webAssets[NUMWEBASSETS] = {")
+    for i, a in enumerate(assets):
+        lines.append("  { %s, %s, webAssetData%d, %d, %s, %s, %s }," % (
+            cString(a["path"]), cString(a["mimeType"]), i, len(a["data"]),
+            "true" if a["gzipped"] else "false", cString(a["eTag"]), cString(a["cacheControl"])))
+    lines.append("};")
+    lines.append("")
+
+    seed, slots = perfectHash([a["path"] for a in assets])
+    lines.append("static const int16_t webAssetSlots[%d] = {" % len(slots))
+    for offset in range(0, len(slots), 16):
+        lines.append("  " + ", ".join("%d" % slot for slot in slots[offset:offset+16]) + ",")
+    lines.append("};")
+    lines.append("")
+    lines.append("static const BolbroAssetTable webAssetTable = { webAssets, webAssetSlots, %d, %du };"
+        % (len(slots), seed))
+
+    with open(headerPath, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+    original = sum(a["originalSize"] for a in assets)
+    embedded = sum(len(a["data"]) for a in assets)
+    print("%d files, %d bytes embedded as %d bytes in %s" % (len(assets), original, embedded, headerPath))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,355 @@
+/* --------------------------------------------------------------------------------
+ *  hc12decode
+ *  decode a raw byte dump of HC-12 traffic (e.g. captured with a USB UART dongle)
+ *  into WeatherPacket and CalibrationPacket records, one JSON object per line;
+ *  statistics go to stderr
+ *
+ *  the dump is memory mapped and split into chunks decoded in parallel; candidate
+ *  frame starts are found by scanning 16 bytes at a time for MAGICBYTE (SSE2,
+ *  memchr elsewhere) and validated using the CRC of Packet
+ *
+ *  frames are the in-memory layout of the packets on the ESP32 from mMagicByte to
+ *  mCRC16, see the offsets below; update them whenever a packet class changes
+ *
+ *  build and run:
+ *    c++ -O2 -std=c++11 -pthread -Itools/host -Ilibraries/Weather \
+ *      -o hc12decode tools/hc12decode/hc12decode.cpp
+ *    ./hc12decode [-j threads] [-q] capture.bin > packets.ndjson
+ *
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include <Packet.h>
+
+Print *LOG = NULL; // Packet.h refers to it, unused here
+
+//  WeatherPacket on the ESP32: vtable pointer and mDecodePos take 5 bytes, doubles
+//  are 8 byte aligned; offsets relative to mMagicByte
+#define WEATHER_RAINDELTA 3 // double
+#define WEATHER_TEMPERATURE 11
+#define WEATHER_PRESSURE 15
+#define WEATHER_HUMIDITY 19
+#define WEATHER_WINDDIRECTION 23 // char[4]
+#define WEATHER_WINDSPEED 27
+#define WEATHER_BATTERYVOLTAGE 31
+#define WEATHER_NUMRAINTIPS 35 // uint8_t
+#define WEATHER_RAINTIPAGES 37 // uint16_t[MAX_RAIN_TIPS]
+#define WEATHER_CRC16 (WEATHER_RAINTIPAGES+2*MAX_RAIN_TIPS)
+#define WEATHER_SIZE (WEATHER_CRC16+2)
+
+//  CalibrationPacket on the ESP32
+#define CALIBRATION_BUCKETTRIGGERVOLUME 3
+#define CALIBRATION_WINDSPEEDFACTOR 7
+#define CALIBRATION_MEASUREMENTHEIGHT 11
+#define CALIBRATION_SECONDSBETWEENREPORTS 15 // uint32_t
+#define CALIBRATION_INCLINATION 19
+#define CALIBRATION_AZIMUTH 23
+#define CALIBRATION_COMMAND 27 // enum, 4 bytes
+#define CALIBRATION_CRC16 31
+#define CALIBRATION_SIZE (CALIBRATION_CRC16+2)
+
+#define MAX_FRAMESIZE (WEATHER_SIZE>CALIBRATION_SIZE?WEATHER_SIZE:CALIBRATION_SIZE)
+#define CHUNKSIZE (16*1024*1024)
+
+struct Statistics {
+  unsigned long candidates; // magic bytes found
+  unsigned long weatherFrames, calibrationFrames;
+  unsigned long failed; // candidates outside valid frames failing the CRC
+
+  Statistics() {
+    candidates = weatherFrames = calibrationFrames = failed = 0;
+  }
+
+  void add(const Statistics &other) {
+    candidates += other.candidates;
+    weatherFrames += other.weatherFrames;
+    calibrationFrames += other.calibrationFrames;
+    failed += other.failed;
+  }
+};
+
+struct Chunk {
+  size_t start, end; // candidates within [start, end) belong to this chunk
+  std::string output;
+  Statistics statistics;
+  size_t lastFrameEnd; // end of the last valid frame, may be beyond end
+  std::vector<size_t> leadingFailures; // offsets of failed candidates possibly within the previous chunk's frame
+};
+
+static const uint8_t *findMagic(const uint8_t *p, const uint8_t *end) {
+#ifdef __SSE2__
+  const __m128i magic = _mm_set1_epi8((char) MAGICBYTE);
+
+  while (end-p>=16) {
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i *) p), magic));
+
+    if (mask)
+      return p+__builtin_ctz(mask);
+    p += 16;
+  }
+
+  while (p<end&&*p!=MAGICBYTE)
+    p++;
+
+  return p;
+#else
+  const uint8_t *found = (const uint8_t *) memchr(p, MAGICBYTE, end-p);
+
+  return found?found:end;
+#endif
+}
+
+static bool validFrame(const uint8_t *frame, int size, int crcOffset) {
+  uint16_t crc;
+
+  memcpy(&crc, frame+crcOffset, sizeof(crc));
+
+  return crc==Packet::crc16(frame, size-sizeof(uint16_t));
+}
+
+static float floatAt(const uint8_t *frame, int offset) {
+  float value;
+
+  memcpy(&value, frame+offset, sizeof(value));
+
+  return value;
+}
+
+//  UNDEFINEDVALUE as null
+static void appendValue(std::string &output, const char *name, double value, int digits) {
+  char buffer[64];
+
+  if (value==UNDEFINEDVALUE)
+    snprintf(buffer, sizeof(buffer), ",\"%s\":null", name);
+  else
+    snprintf(buffer, sizeof(buffer), ",\"%s\":%.*g", name, digits, value);
+
+  output += buffer;
+}
+
+static void appendWeather(std::string &output, size_t offset, const uint8_t *frame) {
+  char buffer[64];
+  double rainDelta;
+
+  memcpy(&rainDelta, frame+WEATHER_RAINDELTA, sizeof(rainDelta));
+
+  snprintf(buffer, sizeof(buffer), "{\"offset\":%zu,\"type\":\"weather\"", offset);
+  output += buffer;
+
+  appendValue(output, "raindelta", rainDelta, 15);
+  appendValue(output, "temperature", floatAt(frame, WEATHER_TEMPERATURE), 7);
+  appendValue(output, "pressure", floatAt(frame, WEATHER_PRESSURE), 7);
+  appendValue(output, "humidity", floatAt(frame, WEATHER_HUMIDITY), 7);
+
+  //  wind direction names only, anything else is garbage
+  const char *direction = (const char *) frame+WEATHER_WINDDIRECTION;
+  bool validDirection = direction[0]!='\0';
+
+  for (int i = 0; i<4&&direction[i]; i++)
+    if (!strchr("NESW", direction[i]))
+      validDirection = false;
+
+  if (validDirection&&memchr(direction, '\0', 4)) {
+    output += ",\"winddirection\":\"";
+    output += direction;
+    output += "\"";
+  } else
+    output += ",\"winddirection\":null";
+
+  appendValue(output, "windspeed", floatAt(frame, WEATHER_WINDSPEED), 7);
+  appendValue(output, "batteryvoltage", floatAt(frame, WEATHER_BATTERYVOLTAGE), 7);
+
+  int numRainTips = frame[WEATHER_NUMRAINTIPS];
+
+  snprintf(buffer, sizeof(buffer), ",\"raintips\":%d,\"raintipages\":[", numRainTips);
+  output += buffer;
+
+  for (int i = 0; i<numRainTips&&i<MAX_RAIN_TIPS; i++) {
+    uint16_t age;
+
+    memcpy(&age, frame+WEATHER_RAINTIPAGES+i*sizeof(uint16_t), sizeof(age));
+    snprintf(buffer, sizeof(buffer), "%s%.1f", i?",":"", age/10.0);
+    output += buffer;
+  }
+
+  output += "]}\n";
+}
+
+static void appendCalibration(std::string &output, size_t offset, const uint8_t *frame) {
+  char buffer[96];
+  uint32_t secondsBetweenReports, command;
+
+  memcpy(&secondsBetweenReports, frame+CALIBRATION_SECONDSBETWEENREPORTS, sizeof(secondsBetweenReports));
+  memcpy(&command, frame+CALIBRATION_COMMAND, sizeof(command));
+
+  snprintf(buffer, sizeof(buffer), "{\"offset\":%zu,\"type\":\"calibration\"", offset);
+  output += buffer;
+
+  appendValue(output, "buckettriggervolume", floatAt(frame, CALIBRATION_BUCKETTRIGGERVOLUME), 7);
+  appendValue(output, "windspeedfactor", floatAt(frame, CALIBRATION_WINDSPEEDFACTOR), 7);
+  appendValue(output, "measurementheight", floatAt(frame, CALIBRATION_MEASUREMENTHEIGHT), 7);
+
+  snprintf(buffer, sizeof(buffer), ",\"secondsbetweenreports\":%u", (unsigned) secondsBetweenReports);
+  output += buffer;
+
+  appendValue(output, "inclination", floatAt(frame, CALIBRATION_INCLINATION), 7);
+  appendValue(output, "azimuth", floatAt(frame, CALIBRATION_AZIMUTH), 7);
+
+  snprintf(buffer, sizeof(buffer), ",\"command\":%u}\n", (unsigned) command);
+  output += buffer;
+}
+
+//  candidates within a valid frame are skipped like the base's decoder does
+static void decodeChunk(const uint8_t *data, size_t size, Chunk &chunk, bool quiet) {
+  const uint8_t *p = data+chunk.start, *end = data+chunk.end;
+
+  chunk.lastFrameEnd = 0;
+
+  for (p = findMagic(p, end); p<end; p = findMagic(p, end)) {
+    size_t offset = p-data, remaining = size-offset;
+
+    chunk.statistics.candidates++;
+
+    if (remaining>=WEATHER_SIZE&&validFrame(p, WEATHER_SIZE, WEATHER_CRC16)) {
+      chunk.statistics.weatherFrames++;
+      if (!quiet)
+        appendWeather(chunk.output, offset, p);
+      p += WEATHER_SIZE;
+    } else if (remaining>=CALIBRATION_SIZE&&validFrame(p, CALIBRATION_SIZE, CALIBRATION_CRC16)) {
+      chunk.statistics.calibrationFrames++;
+      if (!quiet)
+        appendCalibration(chunk.output, offset, p);
+      p += CALIBRATION_SIZE;
+    } else {
+      chunk.statistics.failed++;
+      if (offset<chunk.start+MAX_FRAMESIZE)
+        chunk.leadingFailures.push_back(offset);
+      p++;
+      continue;
+    }
+
+    chunk.lastFrameEnd = p-data;
+  }
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+}
+
+int main(int argc, char **argv) {
+  int numThreads = std::thread::hardware_concurrency();
+  bool quiet = false;
+  const char *path = NULL;
+
+  for (int i = 1; i<argc; i++) {
+    if (strcmp(argv[i], "-j")==0&&i+1<argc)
+      numThreads = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-q")==0)
+      quiet = true;
+    else if (argv[i][0]=='-'||path) {
+      fprintf(stderr, "usage: %s [-j threads] [-q] capture.bin\n", argv[0]);
+      return 1;
+    } else
+      path = argv[i];
+  }
+
+  if (!path) {
+    fprintf(stderr, "usage: %s [-j threads] [-q] capture.bin\n", argv[0]);
+    return 1;
+  }
+
+  if (numThreads<1)
+    numThreads = 1;
+
+  int fd = open(path, O_RDONLY);
+  struct stat status;
+
+  if (fd<0||fstat(fd, &status)<0) {
+    perror(path);
+    return 1;
+  }
+
+  size_t size = status.st_size;
+  const uint8_t *data = NULL;
+
+  if (size>0) {
+    data = (const uint8_t *) mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data==MAP_FAILED) {
+      perror(path);
+      return 1;
+    }
+    madvise((void *) data, size, MADV_SEQUENTIAL);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  Statistics statistics;
+  size_t previousFrameEnd = 0;
+
+  //  decode numThreads chunks at a time, write them in order
+  for (size_t waveStart = 0; waveStart<size; waveStart += (size_t) numThreads*CHUNKSIZE) {
+    std::vector<Chunk> chunks;
+
+    for (size_t chunkStart = waveStart; chunkStart<size&&chunks.size()<(size_t) numThreads; chunkStart += CHUNKSIZE) {
+      chunks.emplace_back();
+      chunks.back().start = chunkStart;
+      chunks.back().end = chunkStart+CHUNKSIZE<size?chunkStart+CHUNKSIZE:size;
+    }
+
+    std::vector<std::thread> threads;
+
+    for (Chunk &chunk : chunks)
+      threads.emplace_back([&]() { decodeChunk(data, size, chunk, quiet); });
+    for (std::thread &thread : threads)
+      thread.join();
+
+    for (Chunk &chunk : chunks) {
+      //  the previous chunk's last frame may reach into this one
+      for (size_t offset : chunk.leadingFailures)
+        if (offset<previousFrameEnd) {
+          chunk.statistics.candidates--;
+          chunk.statistics.failed--;
+        }
+
+      statistics.add(chunk.statistics);
+      fwrite(chunk.output.data(), 1, chunk.output.size(), stdout);
+
+      if (chunk.lastFrameEnd)
+        previousFrameEnd = chunk.lastFrameEnd;
+    }
+  }
+
+  fflush(stdout);
+
+  double seconds = secondsSince(start);
+
+  fprintf(stderr, "%zu bytes in %.3f s using %d threads, %.1f MB/s\n",
+    size, seconds, numThreads, size/seconds/1e6);
+  fprintf(stderr, "%lu weather packets, %lu calibration packets\n",
+    statistics.weatherFrames, statistics.calibrationFrames);
+  fprintf(stderr, "%lu of %lu frame candidates failed the CRC (corrupt frames, or magic bytes within noise)\n",
+    statistics.failed, statistics.candidates);
+  fprintf(stderr, "%zu bytes outside valid frames\n",
+    size-statistics.weatherFrames*WEATHER_SIZE-statistics.calibrationFrames*CALIBRATION_SIZE);
+
+  if (data)
+    munmap((void *) data, size);
+  close(fd);
+
+  return 0;
+}
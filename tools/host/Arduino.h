@@ -0,0 +1,107 @@
+/* --------------------------------------------------------------------------------
+ *  Arduino.h for host tools
+ *  just enough of the Arduino core to compile the weatherbase classes with a
+ *  desktop compiler: millis() is set by the tool per thread, Print discards all
+ *  output, and String covers the operations used by the packet classes
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+#ifndef _HOST_ARDUINO_H_
+#define _HOST_ARDUINO_H_
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <string>
+
+typedef uint8_t byte;
+
+//  simulated time, set by the tool before handing a reading to the classes
+extern thread_local unsigned long hostMillis;
+
+inline unsigned long millis() {
+  return hostMillis;
+}
+
+#define constrain(amt, low, high) ((amt)<(low)?(low):((amt)>(high)?(high):(amt)))
+
+//  logging is compiled away
+class Print
+{
+  public:
+
+    template<class... Args> size_t print(Args...) {
+      return 0;
+    }
+
+    template<class... Args> size_t println(Args...) {
+      return 0;
+    }
+
+    template<class... Args> size_t printf(const char *, Args...) {
+      return 0;
+    }
+
+    template<class... Args> size_t write(Args...) {
+      return 0;
+    }
+};
+
+class String
+{
+  public:
+
+    String(const char *s = "") : mString(s) {}
+
+    String(const std::string &s) : mString(s) {}
+
+    String(int value) : mString(std::to_string(value)) {}
+
+    String(long value) : mString(std::to_string(value)) {}
+
+    String(double value, int decimals = 2) {
+      char buffer[64];
+
+      snprintf(buffer, sizeof(buffer), "%.*f", decimals, value);
+      mString = buffer;
+    }
+
+    String &operator+=(const String &s) {
+      mString += s.mString;
+      return *this;
+    }
+
+    String &operator+=(const char *s) {
+      mString += s;
+      return *this;
+    }
+
+    void concat(const char *s) {
+      mString += s;
+    }
+
+    unsigned int length() const {
+      return mString.length();
+    }
+
+    const char *c_str() const {
+      return mString.c_str();
+    }
+
+    friend String operator+(const String &a, const String &b) {
+      return String(a.mString+b.mString);
+    }
+
+    friend String operator+(const String &a, const char *b) {
+      return String(a.mString+b);
+    }
+
+  private:
+
+    std::string mString;
+};
+
+#endif // _HOST_ARDUINO_H_
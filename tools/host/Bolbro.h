@@ -0,0 +1,16 @@
+/* --------------------------------------------------------------------------------
+ *  Bolbro.h for host tools
+ *  declarations the weatherbase classes use from the Bolbro library
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+#ifndef Bolbro_h
+#define Bolbro_h
+
+#include <Arduino.h>
+
+#define STRINGNOTINITIALIZED  "-"
+
+extern Print *LOG;
+
+#endif
@@ -0,0 +1,384 @@
+/* --------------------------------------------------------------------------------
+ *  reaggregate
+ *  recompute the daily aggregates of weatherbase from archive files copied from
+ *  the base, e.g. to check the effect of changed filter or aggregation code; the
+ *  readings are run through the sketch's SampleFilter, History, and DailyMinMax
+ *  classes, days are processed in parallel on all cores
+ *
+ *  each day is processed on its own, starting WARMUP_SECONDS early so histories
+ *  hold the same readings as in a continuous run; -s runs everything in one pass
+ *  instead, which serves as the reference (compare the output using -x)
+ *
+ *  results are close to those of the base but not bit for bit identical: the base's
+ *  compiler fuses multiply-adds where this tool is built not to, and a day's warmup
+ *  may leave a SampleFilter in a different resync state than the continuous run
+ *  (-s) does; readings are times in whole seconds and values quantized as archived
+ *  (see ArchiveBlock.h)
+ *
+ *  build and run:
+ *    c++ -O2 -std=c++17 -pthread -ffp-contract=off -Itools/host -Ilibraries/Bolbro \
+ *      -Ilibraries/Weather -Isketches/weatherbase -o reaggregate tools/reaggregate/reaggregate.cpp
+ *    ./reaggregate [-j threads] [-s] [-x] [-z timezone] archive.old archive.bin
+ *
+ *  Harald Schlangmann, October 2026
+ * -------------------------------------------------------------------------------- */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+#include <Bolbro.h>
+#include <WeatherPacket.h>
+
+#include "History.h"
+#include "DailyMinMax.h"
+#include "SampleFilter.h"
+#include "FilterLimits.h"
+#include "ArchiveBlock.h"
+
+#define WARMUP_SECONDS (3*60*60) // longest history horizon of the base
+#define DEFAULT_TIMEZONE "CET-1CEST,M3.5.0,M10.5.0/3" // what the base is configured to
+
+thread_local unsigned long hostMillis = 0;
+
+static Print hostLog;
+Print *LOG = &hostLog;
+
+static bool hexFloats = false;
+
+//  aggregates of one day as printed
+struct DayResult {
+  time_t start;
+  long numPackets, numRejected;
+  bool hasTemperature, hasRain, hasWind, hasPressure;
+  float minTemperature, maxTemperature, avgTemperature;
+  float rain;
+  float maxGust, maxWind; // maximum sample, maximum 10 minute average
+  float avgPressure;
+};
+
+//  the filters and aggregates of the base, keep in sync with filterPacket() and
+//  updateAggregates() in weatherbase.ino.customize; limits are shared
+class Pipeline
+{
+  public:
+
+    Pipeline() :
+      mTemperatureFilter(temperatureLimits),
+      mPressureFilter(pressureLimits),
+      mHumidityFilter(humidityLimits),
+      mWindSpeedFilter(windSpeedLimits),
+      mRainFilter(rainLimits),
+      mWindHistory("wind", 10*60),
+      mTemperatureMinMax("temperature"),
+      mRainMinMax("rain"),
+      mWindMinMax("wind"),
+      mPressureMinMax("pressure") {
+      startDay();
+    }
+
+    //  warmup readings update filters and histories only
+    void addRecord(const ArchiveRecord &record, bool warmup) {
+      WeatherPacket packet;
+
+      hostMillis = record.time*1000ul;
+
+      packet.mTemperatureDegreeCelsius = record.values[TemperatureChannel];
+      packet.mPressureHPA = record.values[PressureChannel];
+      packet.mHumidityPercent = record.values[HumidityChannel];
+      packet.mWindSpeedMpS = record.values[WindSpeedChannel];
+      strcpy(packet.mWindDirection, WeatherPacket::windDirectionName((int) record.values[WindDirectionChannel]));
+      packet.mDeltaRainMM = record.values[RainChannel];
+      packet.mBatteryVoltage = record.values[BatteryChannel];
+
+      long numRejected = rejected();
+
+      filterValue(mTemperatureFilter, packet.mTemperatureDegreeCelsius);
+      filterValue(mPressureFilter, packet.mPressureHPA);
+      filterValue(mHumidityFilter, packet.mHumidityPercent);
+      filterValue(mWindSpeedFilter, packet.mWindSpeedMpS);
+
+      float deltaRainMM = packet.mDeltaRainMM;
+
+      filterValue(mRainFilter, deltaRainMM);
+      if (deltaRainMM==UNDEFINEDVALUE)
+        packet.mDeltaRainMM = UNDEFINEDVALUE;
+
+      if (packet.mWindSpeedMpS!=UNDEFINEDVALUE)
+        mWindHistory.addSample(packet.mWindSpeedMpS);
+
+      //  as DerivedMetrics::update(), aggregates the history once per packet; the
+      //  history expires samples on new samples only, so the average counts along
+      //  with a sample only, otherwise it may stem from before the warmup
+      float windAvg = UNDEFINEDVALUE;
+
+      if (mWindHistory.hasSamples()) {
+        float avg = mWindHistory.avg();
+
+        mWindHistory.max();
+        if (packet.mWindSpeedMpS!=UNDEFINEDVALUE)
+          windAvg = avg;
+      }
+
+      if (warmup)
+        return;
+
+      time_t time = record.time;
+
+      if (packet.mTemperatureDegreeCelsius!=UNDEFINEDVALUE)
+        mTemperatureMinMax.addSample(packet.mTemperatureDegreeCelsius, time);
+      if (packet.mWindSpeedMpS!=UNDEFINEDVALUE)
+        mWindMinMax.addSample(packet.mWindSpeedMpS, time);
+      if (packet.mDeltaRainMM!=UNDEFINEDVALUE)
+        mRainMinMax.addDeltaSample(packet.mDeltaRainMM, time);
+      if (packet.mPressureHPA!=UNDEFINEDVALUE)
+        mPressureMinMax.addSample(packet.mPressureHPA, time);
+
+      if (windAvg!=UNDEFINEDVALUE&&(mMaxWind==UNDEFINEDVALUE||windAvg>mMaxWind))
+        mMaxWind = windAvg;
+
+      mNumPackets++;
+      mNumRejected += rejected()-numRejected;
+    }
+
+    //  roll over at the end of the day starting at start, the day's results become
+    //  available as yesterday
+    bool finishDay(time_t start, time_t end, DayResult &result) {
+      mTemperatureMinMax.checkRollover(end);
+      mRainMinMax.checkRollover(end);
+      mWindMinMax.checkRollover(end);
+      mPressureMinMax.checkRollover(end);
+
+      result.start = start;
+      result.numPackets = mNumPackets;
+      result.numRejected = mNumRejected;
+      result.maxWind = mMaxWind;
+
+      result.hasTemperature = mTemperatureMinMax.hasSamples(DailyMinMax::Yesterday);
+      if (result.hasTemperature) {
+        result.minTemperature = mTemperatureMinMax.min(DailyMinMax::Yesterday);
+        result.maxTemperature = mTemperatureMinMax.max(DailyMinMax::Yesterday);
+        result.avgTemperature = mTemperatureMinMax.avg(DailyMinMax::Yesterday);
+      }
+
+      result.hasRain = mRainMinMax.hasSamples(DailyMinMax::Yesterday);
+      if (result.hasRain)
+        result.rain = mRainMinMax.sum(DailyMinMax::Yesterday);
+
+      result.hasWind = mWindMinMax.hasSamples(DailyMinMax::Yesterday);
+      if (result.hasWind)
+        result.maxGust = mWindMinMax.max(DailyMinMax::Yesterday);
+
+      result.hasPressure = mPressureMinMax.hasSamples(DailyMinMax::Yesterday);
+      if (result.hasPressure)
+        result.avgPressure = mPressureMinMax.avg(DailyMinMax::Yesterday);
+
+      bool hasPackets = mNumPackets>0;
+
+      startDay();
+
+      return hasPackets;
+    }
+
+  private:
+
+    SampleFilter mTemperatureFilter, mPressureFilter, mHumidityFilter, mWindSpeedFilter, mRainFilter;
+    History mWindHistory;
+    DailyMinMax mTemperatureMinMax, mRainMinMax, mWindMinMax, mPressureMinMax;
+
+    long mNumPackets, mNumRejected;
+    float mMaxWind;
+
+    void startDay() {
+      mNumPackets = mNumRejected = 0;
+      mMaxWind = UNDEFINEDVALUE;
+    }
+
+    static void filterValue(SampleFilter &filter, float &value) {
+      if (value!=UNDEFINEDVALUE&&!filter.accept(value))
+        value = UNDEFINEDVALUE;
+    }
+
+    long rejected() {
+      SampleFilter *filters[] = {
+        &mTemperatureFilter, &mPressureFilter, &mHumidityFilter, &mWindSpeedFilter, &mRainFilter
+      };
+      long numRejected = 0;
+
+      for (SampleFilter *filter : filters)
+        numRejected += filter->count(SampleFilter::OutOfBounds)
+          +filter->count(SampleFilter::TooFast)+filter->count(SampleFilter::Spike);
+
+      return numRejected;
+    }
+};
+
+static double secondsSince(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+}
+
+static void load(const char *path, std::vector<ArchiveRecord> &records) {
+  FILE *file = fopen(path, "rb");
+
+  if (!file) {
+    perror(path);
+    exit(1);
+  }
+
+  ArchiveBlock block;
+
+  while (fread(block.bytes(), 1, ARCHIVE_BLOCKSIZE, file)==ARCHIVE_BLOCKSIZE) {
+    ArchiveBlockReader reader(block);
+    ArchiveRecord record;
+
+    while (reader.next(record))
+      records.push_back(record);
+  }
+
+  fclose(file);
+}
+
+static void printValue(bool valid, float value, int precision) {
+  if (!valid)
+    printf(",");
+  else if (hexFloats)
+    printf(",%a", value);
+  else
+    printf(",%.*f", precision, value);
+}
+
+static void printDay(const DayResult &day) {
+  struct tm t;
+  char date[16];
+
+  localtime_r(&day.start, &t);
+  strftime(date, sizeof(date), "%Y-%m-%d", &t);
+
+  printf("%s,%ld,%ld", date, day.numPackets, day.numRejected);
+  printValue(day.hasTemperature, day.minTemperature, 2);
+  printValue(day.hasTemperature, day.maxTemperature, 2);
+  printValue(day.hasTemperature, day.avgTemperature, 2);
+  printValue(day.hasRain, day.rain, 2);
+  printValue(day.hasWind, day.maxGust, 2);
+  printValue(day.maxWind!=UNDEFINEDVALUE, day.maxWind, 2);
+  printValue(day.hasPressure, day.avgPressure, 2);
+  printf("\n");
+}
+
+int main(int argc, char **argv) {
+  int numThreads = std::thread::hardware_concurrency();
+  bool sequential = false;
+  const char *timezone = DEFAULT_TIMEZONE;
+  std::vector<const char *> paths;
+
+  for (int i = 1; i<argc; i++) {
+    if (strcmp(argv[i], "-j")==0&&i+1<argc)
+      numThreads = atoi(argv[++i]);
+    else if (strcmp(argv[i], "-s")==0)
+      sequential = true;
+    else if (strcmp(argv[i], "-x")==0)
+      hexFloats = true;
+    else if (strcmp(argv[i], "-z")==0&&i+1<argc)
+      timezone = argv[++i];
+    else if (argv[i][0]=='-') {
+      fprintf(stderr, "usage: %s [-j threads] [-s] [-x] [-z timezone] archive.old archive.bin\n", argv[0]);
+      return 1;
+    } else
+      paths.push_back(argv[i]);
+  }
+
+  setenv("TZ", timezone, 1);
+  tzset();
+
+  //  archive files in order, oldest first
+  std::vector<ArchiveRecord> records;
+
+  for (const char *path : paths)
+    load(path, records);
+
+  if (records.empty()) {
+    fprintf(stderr, "no readings found\n");
+    return 1;
+  }
+
+  //  local day boundaries, the last one ends the last day
+  std::vector<time_t> dayStarts;
+  std::vector<size_t> dayFirstRecords;
+
+  for (size_t i = 0; i<records.size(); i++) {
+    struct tm day;
+    time_t start = DailyMinMax::startOfDaySeconds(records[i].time, &day);
+
+    if (dayStarts.empty()||start>dayStarts.back()) {
+      dayStarts.push_back(start);
+      dayFirstRecords.push_back(i);
+    }
+  }
+
+  int numDays = dayStarts.size();
+  std::vector<DayResult> results(numDays);
+  std::vector<char> hasResults(numDays); // not vector<bool>, written concurrently
+  auto start = std::chrono::steady_clock::now();
+
+  auto dayEnd = [&](int d) {
+    struct tm day;
+
+    localtime_r(&dayStarts[d], &day);
+
+    return DailyMinMax::nextDaySeconds(day);
+  };
+
+  if (sequential) {
+    Pipeline pipeline;
+
+    numThreads = 1;
+    for (int d = 0; d<numDays; d++) {
+      size_t last = d+1<numDays?dayFirstRecords[d+1]:records.size();
+
+      for (size_t i = dayFirstRecords[d]; i<last; i++)
+        pipeline.addRecord(records[i], false);
+      hasResults[d] = pipeline.finishDay(dayStarts[d], dayEnd(d), results[d]);
+    }
+  } else {
+    std::atomic<int> nextDay(0);
+    std::vector<std::thread> threads;
+
+    if (numThreads<1)
+      numThreads = 1;
+
+    for (int t = 0; t<numThreads; t++)
+      threads.emplace_back([&]() {
+        for (int d = nextDay++; d<numDays; d = nextDay++) {
+          Pipeline pipeline;
+          size_t first = dayFirstRecords[d];
+          size_t last = d+1<numDays?dayFirstRecords[d+1]:records.size();
+          size_t warmup = first;
+
+          while (warmup>0&&records[warmup-1].time+WARMUP_SECONDS>=(uint32_t) dayStarts[d])
+            warmup--;
+
+          for (size_t i = warmup; i<last; i++)
+            pipeline.addRecord(records[i], i<first);
+          hasResults[d] = pipeline.finishDay(dayStarts[d], dayEnd(d), results[d]);
+        }
+      });
+
+    for (std::thread &thread : threads)
+      thread.join();
+  }
+
+  double seconds = secondsSince(start);
+
+  printf("date,packets,rejected,mintemperature,maxtemperature,avgtemperature,rain,maxgust,maxwind,avgpressure\n");
+  for (int d = 0; d<numDays; d++)
+    if (hasResults[d])
+      printDay(results[d]);
+
+  fprintf(stderr, "%zu packets, %d days in %.3f s using %d threads, %.0f packets/s\n",
+    records.size(), numDays, seconds, numThreads, records.size()/seconds);
+
+  return 0;
+}